@@ -11,7 +11,7 @@ template <>
 struct out::formatter<vec2> {
     template <class S>
     static out::result<std::size_t> write(S& sink, const vec2& v, out::fmt_spec) noexcept {
-        return out::try_print<"({}, {})">(sink, v.x, v.y);
+        return out::format_into<"({}, {})">(sink, v.x, v.y);
     }
 };
 
@@ -160,6 +160,21 @@ extern "C" void example()
         .set_newline(out::newline::lf)
         .println<"LF newline">();
 
+    // Flush coalescing: loggers sharing one policy flush console every 4 KiB,
+    // every 50 ms, or immediately on warn/error.
+#if defined(OUT_NO_BYTE_COUNT)
+    out::flush_policy console_flush{.every_ms = 50};
+#else
+    out::flush_policy console_flush{.every_bytes = 4096, .every_ms = 50};
+#endif
+    out::log<out::level::info>(console).flush_with(console_flush).println<"Coalesced flush">();
+    out::log<out::level::warn>(console).flush_with(console_flush).println<"Warn flushes now">();
+
+    // JSON Lines: one object per record with ts/level/domain/msg and the arguments.
+    out::log<out::level::info, network_domain>(console)
+        .json()
+        .println<"Connected to {} in {} ms">(std::string_view{"10.0.0.2"}, 12);
+
     // ------------------------------------------------------------
     // Sinks: line-buffered + fixed buffer
     // ------------------------------------------------------------
@@ -171,6 +186,19 @@ extern "C" void example()
     out::print<"More: {}\r\n">(buf, "OK");
     out::print<"{}\r\n">(console, buf.view());
 
+    // Fan-out: format once, colored console + plain capture buffer (warn and up).
+    out::buffer_sink<256> warn_log;
+    out::tee_sink both{console_ansi, warn_log};
+    both.set_level(1, out::level::warn);
+    out::info<"Tee: {}console only{}">(both, out::fg(out::color::cyan), out::reset);
+    out::warn<"Tee: {}console and buffer{}">(both, out::fg(out::color::yellow), out::reset);
+    out::print<"{}">(console, warn_log.view());
+
+    // Flight recorder: always accepts writes, keeps the newest whole lines.
+    out::ring_sink<128> history;
+    for (int i = 0; i < 16; ++i) out::debug<"step {} done">(history, i);
+    (void)history.dump_to(console); // dump on error / operator request
+
 #if 0
     // ------------------------------------------------------------
     // Dev sink experiments: write/ansi/flush metrics
@@ -0,0 +1,65 @@
+#include <cstdint>
+#include <string_view>
+#include <time.h>
+
+import out.api;
+
+// impl in example.cpp
+extern "C" void example();
+
+struct link_domain {};
+template <> inline constexpr std::string_view out::domain_name<link_domain> = "link";
+
+// Compile-time routing: link errors are also kept in a buffer for the status page.
+static out::buffer_sink<256> link_errors;
+template <> inline constexpr auto out::domain_also_sink<link_domain, out::level::error> = &link_errors;
+
+static std::uint64_t unix_nanos() noexcept
+{
+    timespec ts{};
+    ::clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000u + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+int main()
+{
+    example();
+
+    // Local log daemon: one datagram per record, level/domain mapped to
+    // syslog priority / MSGID (or journald PRIORITY / OUT_DOMAIN fields).
+    out::posix::unix_log_sink<> syslog{"/dev/log", out::posix::log_protocol::rfc5424, "out-example"};
+    if (syslog.is_open()) {
+        out::warn<"syslog: disk usage {}%">(syslog, 91);
+        out::log<out::level::info, link_domain>(syslog).println<"syslog: link up">();
+    }
+
+    out::posix::unix_log_sink<> journal{"/run/systemd/journal/socket", out::posix::log_protocol::journald, "out-example"};
+    if (journal.is_open()) {
+        out::log<out::level::error, link_domain>(journal)
+            .no_flush()
+            .println<"journald: peer {} unreachable">(std::string_view{"10.0.0.2"});
+        (void)journal.flush();
+    }
+
+    out::log<out::level::error, link_domain>().println<"link: carrier lost">();
+    out::print<"link errors kept: {}">(link_errors.view());
+
+    // Crash-surviving history; recover it with `out-ringdump /tmp/out-example.ring`.
+    out::posix::mmap_ring_sink ring{"/tmp/out-example.ring", 64 * 1024};
+    out::info<"ring: example run finished">(ring);
+
+    // OTLP LogRecords, one length-delimited protobuf message per atomic append.
+    out::posix::append_record_sink<> otlp_file{"/tmp/out-example.otlp"};
+    if (otlp_file.is_open()) {
+        out::otlp::log_sink otlp{otlp_file, unix_nanos};
+        out::log<out::level::warn, link_domain>(otlp)
+            .level_prefix(false)
+            .println<"otlp: retransmits {}">(3);
+    }
+
+    // Out-of-process logging; run `out-collector /out-example` to drain it.
+    out::posix::shm_channel_sink channel{"/out-example", 64 * 1024};
+    if (channel.is_open())
+        out::info<"shm: example run finished">(channel);
+    return 0;
+}
@@ -0,0 +1,86 @@
+// Drains an out::posix::shm_channel_sink from another process to a file or
+// stdout, keeping disk/terminal I/O off the logging process.
+//   usage: out-collector <shm-name> [output-file] [--poll-us N]
+// Without --poll-us the collector sleeps on a futex and the producer wakes it;
+// with it, the collector polls every N microseconds and never costs the
+// producer a syscall.
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <time.h>
+
+import out.api;
+
+namespace {
+    volatile std::sig_atomic_t g_stop = 0;
+
+    struct file_sink {
+        std::FILE* f;
+        out::result<std::size_t> write(out::bytes b) noexcept {
+            if (b.empty()) return out::ok(std::size_t{0});
+            const auto n = std::fwrite(b.data(), 1, b.size(), f);
+            if (n != b.size()) return std::unexpected(out::errc::io_error);
+            return out::ok(n);
+        }
+        out::result<void> flush() noexcept {
+            if (std::fflush(f) != 0) return std::unexpected(out::errc::io_error);
+            return {};
+        }
+    };
+}
+
+int main(int argc, char** argv)
+{
+    const char* name = nullptr;
+    const char* path = nullptr;
+    long poll_us = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--poll-us") == 0 && i + 1 < argc) poll_us = std::atol(argv[++i]);
+        else if (!name) name = argv[i];
+        else if (!path) path = argv[i];
+        else name = nullptr, i = argc;
+    }
+    if (!name) {
+        std::fprintf(stderr, "usage: %s <shm-name> [output-file] [--poll-us N]\n", argv[0]);
+        return 2;
+    }
+
+    std::signal(SIGINT, [](int) { g_stop = 1; });
+    std::signal(SIGTERM, [](int) { g_stop = 1; });
+
+    // The producer creates the channel; wait for it to appear.
+    std::optional<out::posix::shm_channel_reader> reader;
+    while (!g_stop) {
+        if (reader.emplace(name).is_open()) break;
+        reader.reset();
+        timespec ts{0, 100 * 1000000L};
+        ::nanosleep(&ts, nullptr);
+    }
+    if (!reader) return 0;
+
+    file_sink sink{path ? std::fopen(path, "ab") : stdout};
+    if (!sink.f) {
+        std::perror(path);
+        return 1;
+    }
+
+    int rc = 0;
+    while (!g_stop) {
+        auto r = reader->poll(sink);
+        if (!r) { rc = 1; break; }
+        if (*r != 0) { (void)sink.flush(); continue; }
+        if (poll_us > 0) {
+            timespec ts{poll_us / 1000000, (poll_us % 1000000) * 1000L};
+            ::nanosleep(&ts, nullptr);
+        } else {
+            reader->wait(100);
+        }
+    }
+    (void)reader->poll(sink);
+    (void)sink.flush();
+    if (const auto d = reader->dropped()) std::fprintf(stderr, "%s: %llu writes dropped\n", name, static_cast<unsigned long long>(d));
+    if (path) std::fclose(sink.f);
+    return rc;
+}
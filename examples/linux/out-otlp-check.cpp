@@ -0,0 +1,209 @@
+// End-to-end check for out::otlp::log_sink: logs through it into an
+// out::posix::append_record_sink file (the stand-in for a collector pipe),
+// then reads the file back and decodes it with a minimal protobuf reader.
+// Checks the varint length framing, time_unix_nano, severity_number/text, the
+// AnyValue body, the "domain" attribute, CR/LF stripping and the MaxBody and
+// domain-name truncation.
+//   usage: out-otlp-check [file]
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+import out.api;
+
+static_assert(out::build_level >= out::level::info, "build with LOG_LEVEL_INFO or higher");
+
+struct link_domain {};
+template <> inline constexpr std::string_view out::domain_name<link_domain> = "link";
+
+struct long_domain {};
+template <> inline constexpr std::string_view out::domain_name<long_domain> =
+    "a-domain-name-that-is-longer-than-the-sixty-four-bytes-kept-by-the-sink";
+
+namespace {
+    int g_failures = 0;
+
+    void expect(bool ok, const char* what, std::string_view got = {}) {
+        if (ok) return;
+        ++g_failures;
+        std::printf("FAIL: %s: [%.*s]\n", what, static_cast<int>(got.size()), got.data());
+    }
+
+    std::uint64_t g_now = 1'700'000'000'000'000'000ull;
+    std::uint64_t fake_clock() noexcept { return g_now; }
+
+    // Just enough protobuf to read LogRecord back; any malformed input clears ok.
+    struct reader {
+        std::string_view in;
+        bool ok = true;
+
+        bool done() const noexcept { return in.empty() || !ok; }
+
+        std::uint64_t varint() noexcept {
+            std::uint64_t v = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (in.empty()) break;
+                const auto c = static_cast<unsigned char>(in.front());
+                in.remove_prefix(1);
+                v |= std::uint64_t{c & 0x7Fu} << shift;
+                if ((c & 0x80u) == 0) return v;
+            }
+            ok = false;
+            return 0;
+        }
+
+        std::uint64_t fixed64() noexcept {
+            if (in.size() < 8) {
+                ok = false;
+                return 0;
+            }
+            std::uint64_t v = 0;
+            for (int i = 0; i < 8; ++i) v |= std::uint64_t{static_cast<unsigned char>(in[i])} << (8 * i);
+            in.remove_prefix(8);
+            return v;
+        }
+
+        std::string_view bytes() noexcept {
+            const std::uint64_t n = varint();
+            if (!ok || n > in.size()) {
+                ok = false;
+                return {};
+            }
+            auto s = in.substr(0, n);
+            in.remove_prefix(n);
+            return s;
+        }
+    };
+
+    struct record {
+        bool has_time = false;
+        std::uint64_t time = 0;
+        std::uint64_t severity = 0;
+        std::string severity_text;
+        std::string body;
+        std::vector<std::pair<std::string, std::string>> attributes;
+    };
+
+    // AnyValue: only string_value (1) is produced by the sink.
+    std::string any_string(std::string_view msg, bool& ok) {
+        reader r{msg};
+        std::string s;
+        while (!r.done()) {
+            const auto tag = r.varint();
+            if (tag == ((1 << 3) | 2)) s = r.bytes();
+            else r.ok = false;
+        }
+        ok = ok && r.ok;
+        return s;
+    }
+
+    bool decode(std::string_view msg, record& out) {
+        reader r{msg};
+        bool ok = true;
+        while (!r.done()) {
+            const auto tag = r.varint();
+            switch (tag) {
+            case (1 << 3) | 1: out.has_time = true; out.time = r.fixed64(); break;
+            case (2 << 3) | 0: out.severity = r.varint(); break;
+            case (3 << 3) | 2: out.severity_text = r.bytes(); break;
+            case (5 << 3) | 2: out.body = any_string(r.bytes(), ok); break;
+            case (6 << 3) | 2: {
+                reader kv{r.bytes()};
+                std::string key, value;
+                while (!kv.done()) {
+                    const auto t = kv.varint();
+                    if (t == ((1 << 3) | 2)) key = kv.bytes();
+                    else if (t == ((2 << 3) | 2)) value = any_string(kv.bytes(), ok);
+                    else kv.ok = false;
+                }
+                ok = ok && kv.ok;
+                out.attributes.emplace_back(std::move(key), std::move(value));
+                break;
+            }
+            default: r.ok = false; break;
+            }
+        }
+        return ok && r.ok;
+    }
+
+    std::string read_file(const char* path) {
+        std::string s;
+        if (FILE* f = std::fopen(path, "rb")) {
+            char buf[4096];
+            std::size_t n;
+            while ((n = std::fread(buf, 1, sizeof(buf), f)) != 0) s.append(buf, n);
+            std::fclose(f);
+        }
+        return s;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::string path = (argc > 1) ? argv[1] : "/tmp/out-otlp-check." + std::to_string(::getpid());
+    ::unlink(path.c_str());
+    const std::string long_body(300, 'x');
+    {
+        out::posix::append_record_sink<> file{path.c_str()};
+        if (!file.is_open()) {
+            std::perror(path.c_str());
+            return 2;
+        }
+        out::otlp::log_sink otlp{file, fake_clock};
+        out::log<out::level::warn, link_domain>(otlp).level_prefix(false).println<"retransmits {}">(3);
+        g_now += 1000;
+        out::log<out::level::info>(otlp).println<"plain">();
+        out::log<out::level::error, long_domain>(otlp).level_prefix(false).println<"cut domain">();
+
+        // No clock: time_unix_nano is left out. MaxBody 256 truncates the body,
+        // and the record length needs a two-byte varint.
+        out::otlp::log_sink<out::posix::append_record_sink<>, 256> small{file};
+        out::log<out::level::debug>(small).level_prefix(false).println<"{}">(std::string_view{long_body});
+    }
+
+    const std::string data = read_file(path.c_str());
+    ::unlink(path.c_str());
+
+    std::vector<record> recs;
+    reader frames{data};
+    while (!frames.done()) {
+        const auto msg = frames.bytes();
+        record rec;
+        expect(frames.ok && decode(msg, rec), "malformed LogRecord", msg);
+        recs.push_back(std::move(rec));
+    }
+    expect(frames.ok, "length prefix runs past end of file");
+    expect(recs.size() == 4, "record count", std::to_string(recs.size()));
+    if (recs.size() == 4) {
+        const auto& a = recs[0];
+        expect(a.has_time && a.time == 1'700'000'000'000'000'000ull, "time_unix_nano");
+        expect(a.severity == 13 && a.severity_text == "WARN", "warn severity", a.severity_text);
+        expect(a.body == "retransmits 3", "body without CR/LF", a.body);
+        expect(a.attributes.size() == 1 && a.attributes[0].first == "domain" && a.attributes[0].second == "link",
+               "domain attribute");
+
+        const auto& b = recs[1];
+        expect(b.has_time && b.time == 1'700'000'000'000'001'000ull, "time_unix_nano advances");
+        expect(b.severity == 9 && b.severity_text == "INFO", "info severity", b.severity_text);
+        expect(b.body == "[I] plain", "body keeps the level prefix", b.body);
+        expect(b.attributes.empty(), "no attribute for the default domain");
+
+        const auto& c = recs[2];
+        expect(c.severity == 17 && c.severity_text == "ERROR", "error severity", c.severity_text);
+        expect(c.attributes.size() == 1 &&
+                   c.attributes[0].second == out::domain_name<long_domain>.substr(0, 64),
+               "domain attribute cut to 64 bytes");
+
+        const auto& d = recs[3];
+        expect(!d.has_time, "no time_unix_nano without a clock");
+        expect(d.severity == 5 && d.severity_text == "DEBUG", "debug severity", d.severity_text);
+        expect(d.body == std::string_view{long_body}.substr(0, 256), "body cut to MaxBody", d.body);
+    }
+
+    std::printf("%s: %zu records, %zu bytes\n", g_failures == 0 ? "PASS" : "FAIL", recs.size(), data.size());
+    return g_failures == 0 ? 0 : 1;
+}
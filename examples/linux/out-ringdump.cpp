@@ -0,0 +1,23 @@
+// Recovers the log history from an out::posix::mmap_ring_sink file, even after
+// the writing process crashed or was killed.
+//   usage: out-ringdump <ring-file>
+#include <cstdio>
+
+import out.api;
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <ring-file>\n", argv[0]);
+        return 2;
+    }
+    auto& console = out::port::default_console();
+    auto r = out::posix::dump_mmap_ring(argv[1], console);
+    (void)console.flush();
+    if (!r) {
+        std::fprintf(stderr, "%s: %s\n", argv[1],
+                     r.error() == out::errc::invalid_format ? "not a ring file" : "read error");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+// End-to-end check for out::posix::unix_log_sink: binds a local AF_UNIX
+// SOCK_DGRAM socket as a stand-in for /dev/log or the journald socket, logs
+// through the sink and parses every datagram it receives. Checks the RFC 5424
+// header (PRI, version, APP-NAME/MSGID limits and character set), the journald
+// native fields with the binary MESSAGE length, and that a batch of records
+// sent with one flush() arrives as one datagram per record.
+//   usage: out-unixlog-check [socket-path]
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+import out.api;
+
+static_assert(out::build_level >= out::level::info, "build with LOG_LEVEL_INFO or higher");
+
+struct net_domain {};
+template <> inline constexpr std::string_view out::domain_name<net_domain> = "net";
+
+struct odd_domain {};
+template <> inline constexpr std::string_view out::domain_name<odd_domain> =
+    "a domain name with spaces that is longer than thirty-two bytes";
+
+namespace {
+    int g_failures = 0;
+
+    void expect(bool ok, const char* what, std::string_view got) {
+        if (ok) return;
+        ++g_failures;
+        std::printf("FAIL: %s: [%.*s]\n", what, static_cast<int>(got.size()), got.data());
+    }
+
+    // Next datagram, or an empty string if none is queued.
+    std::string receive(int fd) {
+        char buf[4096];
+        const auto n = ::recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+        return n > 0 ? std::string(buf, static_cast<std::size_t>(n)) : std::string{};
+    }
+
+    bool header_token(std::string_view t, std::size_t max) {
+        if (t.empty() || t.size() > max) return false;
+        for (char c : t) {
+            if (c < 33 || c > 126) return false;
+        }
+        return true;
+    }
+
+    // "<PRI>1 - - APP-NAME PROCID MSGID - MSG"
+    void check_rfc5424(std::string_view d, unsigned pri, std::string_view msgid, std::string_view msg) {
+        std::string_view f[7];
+        std::string_view rest = d;
+        for (auto& x : f) {
+            const auto sp = rest.find(' ');
+            if (sp == std::string_view::npos) {
+                expect(false, "rfc5424 header has fewer than 7 fields", d);
+                return;
+            }
+            x = rest.substr(0, sp);
+            rest.remove_prefix(sp + 1);
+        }
+        const std::string head = "<" + std::to_string(pri) + ">1";
+        expect(f[0] == head, "rfc5424 PRI/VERSION", d);
+        expect(f[1] == "-" && f[2] == "-" && f[6] == "-", "rfc5424 nil TIMESTAMP/HOSTNAME/SD", d);
+        expect(header_token(f[3], 48), "rfc5424 APP-NAME", f[3]);
+        expect(f[4] == std::to_string(::getpid()), "rfc5424 PROCID", f[4]);
+        expect(header_token(f[5], 32), "rfc5424 MSGID", f[5]);
+        if (!msgid.empty()) expect(f[5] == msgid, "rfc5424 MSGID value", f[5]);
+        expect(rest == msg, "rfc5424 MSG", rest);
+    }
+
+    void check_journald(std::string_view d, unsigned sev, std::string_view domain, std::string_view msg) {
+        const std::string pri = "PRIORITY=" + std::to_string(sev) + "\n";
+        expect(d.starts_with(pri), "journald PRIORITY", d);
+        expect(d.find("\nSYSLOG_IDENTIFIER=out-check\n") != std::string_view::npos, "journald SYSLOG_IDENTIFIER", d);
+        if (!domain.empty()) {
+            expect(d.find("\nOUT_DOMAIN=" + std::string(domain) + "\n") != std::string_view::npos, "journald OUT_DOMAIN", d);
+        }
+        const auto at = d.find("\nMESSAGE\n");
+        if (at == std::string_view::npos || d.size() < at + 9 + 8 + 1) {
+            expect(false, "journald binary MESSAGE field", d);
+            return;
+        }
+        std::uint64_t n = 0;
+        for (std::size_t i = 0; i < 8; ++i) n |= std::uint64_t{static_cast<unsigned char>(d[at + 9 + i])} << (8 * i);
+        const std::string_view body = d.substr(at + 17);
+        expect(n + 1 == body.size() && body.back() == '\n', "journald MESSAGE length", d);
+        expect(body.substr(0, body.size() - 1) == msg, "journald MESSAGE", body);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::string path = (argc > 1) ? argv[1] : "/tmp/out-unixlog-check." + std::to_string(::getpid());
+    const int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (fd < 0 || path.size() >= sizeof(addr.sun_path)) {
+        std::perror("socket");
+        return 2;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::perror(path.c_str());
+        return 2;
+    }
+
+    {
+        // RFC 5424, facility user (1): one datagram per record by default.
+        out::posix::unix_log_sink<> sink{path.c_str(), out::posix::log_protocol::rfc5424, "out-check"};
+        out::log<out::level::warn, net_domain>(sink).println<"link {} down">(3);
+        check_rfc5424(receive(fd), 1 * 8 + 4, "net", "[W] link 3 down");
+        out::log<out::level::info>(sink).println<"no domain">();
+        check_rfc5424(receive(fd), 1 * 8 + 6, "-", "[I] no domain");
+        out::log<out::level::error, odd_domain>(sink).println<"clamped">();
+        check_rfc5424(receive(fd), 1 * 8 + 3, "", "[E] clamped");
+    }
+    {
+        // Long, spaced APP-NAME is clamped and sanitised too.
+        out::posix::unix_log_sink<> sink{path.c_str(), out::posix::log_protocol::rfc5424,
+                                         "an ident with spaces and well over forty-eight bytes in total"};
+        out::log<out::level::info>(sink).println<"x">();
+        check_rfc5424(receive(fd), 1 * 8 + 6, "-", "[I] x");
+    }
+    {
+        // journald native protocol, multi-line payload in the binary MESSAGE field.
+        out::posix::unix_log_sink<> sink{path.c_str(), out::posix::log_protocol::journald, "out-check"};
+        out::log<out::level::info, net_domain>(sink).level_prefix(false).println<"two\nlines">();
+        check_journald(receive(fd), 6, "net", "two\nlines");
+    }
+    {
+        // Batching: records staged without per-line flush go out on flush(), one datagram each.
+        out::posix::unix_log_sink<512, 4> sink{path.c_str(), out::posix::log_protocol::rfc5424, "out-check"};
+        auto lg = out::log<out::level::info, net_domain>(sink).no_flush();
+        for (int i = 0; i < 3; ++i) lg.println<"batched {}">(i);
+        expect(receive(fd).empty(), "batched records sent before flush()", {});
+        (void)sink.flush();
+        for (int i = 0; i < 3; ++i) {
+            check_rfc5424(receive(fd), 1 * 8 + 6, "net", "[I] batched " + std::to_string(i));
+        }
+        expect(receive(fd).empty(), "extra datagram after batch", {});
+    }
+
+    ::close(fd);
+    ::unlink(path.c_str());
+    std::printf("%s\n", g_failures == 0 ? "PASS" : "FAIL");
+    return g_failures == 0 ? 0 : 1;
+}
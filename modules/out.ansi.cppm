@@ -1,6 +1,7 @@
 module;
 #include <charconv>
 #include <cstdint>
+#include <cstring>
 #include <expected>
 #include <string_view>
 
@@ -266,6 +267,95 @@ export namespace out {
     inline constexpr bool ansi_is_bytes_v<ansi::ansi_sink_ref<Base, Enabled>> = true;
 }
 
+export namespace out {
+    // Removes escape sequences (CSI "ESC [ ... final", OSC "ESC ] ... BEL/ST" and
+    // two-byte ESC sequences) from the byte stream, so colored output can be
+    // formatted once and also written clean to a file. Clean runs between ESC
+    // bytes are found with memchr (vectorized by the libc) and forwarded to the
+    // base without copying. Parser state survives across writes, so a sequence
+    // split by a buffer flush is still removed. write_ansi() is dropped.
+    template <Sink BaseSink>
+    struct strip_ansi_sink {
+        BaseSink& base;
+
+        explicit strip_ansi_sink(BaseSink& s) noexcept : base(s) {}
+
+        result<std::size_t> write(bytes b) noexcept {
+            auto p = reinterpret_cast<const char*>(b.data());
+            const char* const end = p + b.size();
+            while (p != end) {
+                if (st == state::text) {
+                    auto esc = static_cast<const char*>(std::memchr(p, '\x1b', static_cast<std::size_t>(end - p)));
+                    const char* run_end = esc ? esc : end;
+                    if (run_end != p) {
+                        auto r = base.write(bytes{reinterpret_cast<const std::byte*>(p), static_cast<std::size_t>(run_end - p)});
+                        if (!r) return std::unexpected(r.error());
+                    }
+                    if (!esc) break;
+                    p = esc + 1;
+                    st = state::esc;
+                    continue;
+                }
+                const auto c = static_cast<unsigned char>(*p);
+                switch (st) {
+                case state::esc:
+                    // ESC [ starts CSI, ESC ] starts OSC, intermediates continue, another
+                    // ESC restarts the sequence, anything else ends. Other control bytes
+                    // end it unconsumed, like in CSI, so a stray ESC cannot eat a line.
+                    if (c < 0x20 && c != 0x1B) {
+                        st = state::text;
+                        break;
+                    }
+                    st = (c == '[') ? state::csi : (c == ']') ? state::osc :
+                         ((c >= 0x20 && c <= 0x2F) || c == 0x1B) ? state::esc : state::text;
+                    ++p;
+                    break;
+                case state::csi:
+                    // Parameters/intermediates until a final byte; a control byte aborts
+                    // the sequence and is kept as text so a broken CSI cannot eat a line.
+                    if (c >= 0x40 && c <= 0x7E) { st = state::text; ++p; }
+                    else if (c < 0x20 || c > 0x7E) st = state::text;
+                    else ++p;
+                    break;
+                case state::osc:
+                    if (c == 0x07) { st = state::text; ++p; }
+                    else if (c == 0x1B) { st = state::osc_esc; ++p; }
+                    else if (c == '\n') st = state::text;
+                    else ++p;
+                    break;
+                case state::osc_esc:
+                    // ESC \ (ST) ends the OSC; any other byte starts a new escape.
+                    if (c == '\\') { st = state::text; ++p; }
+                    else st = state::esc;
+                    break;
+                case state::text:
+                    break;
+                }
+            }
+            return ok(b.size());
+        }
+
+        result<std::size_t> write_ansi(std::string_view) noexcept { return ok<std::size_t>(0u); }
+
+        // Passes the logger's record hook (level, domain) on to a base that has one.
+        template <class Level, class B = BaseSink>
+          requires requires(B& b, Level l, std::string_view d) { b.begin_record(l, d); }
+        void begin_record(Level l, std::string_view domain) noexcept { base.begin_record(l, domain); }
+
+        template <class B = BaseSink>
+          requires RecordSink<B>
+        result<std::size_t> end_record() noexcept { return base.end_record(); }
+
+        template <class B = BaseSink>
+          requires Flushable<B>
+        result<std::size_t> flush() noexcept { return base.flush(); }
+
+      private:
+        enum class state : std::uint8_t { text, esc, csi, osc, osc_esc };
+        state st = state::text;
+    };
+}
+
 // ===== Sugar: re-export common ANSI tokens into out namespace =====
 export namespace out {
     using ansi::color;
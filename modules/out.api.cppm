@@ -2,10 +2,11 @@
 #include <cstdint>
 #include <expected>
 #include <string_view>
+#include <type_traits>
 #include <utility>
 export module out.api;
 // Dependency contract (DO NOT VIOLATE)
-// Allowed out.* imports: (re-export only) out.core/out.sink/out.format/out.domain/out.port/out.ansi/out.logger
+// Allowed out.* imports: (re-export only) out.core/out.sink/out.format/out.domain/out.port/out.ansi/out.logger/out.otlp/out.posix/out.tee
 // Forbidden out.* imports: (implementation should stay empty or thin wrappers only)
 // Rationale: public facade; must not reintroduce a second behavior path.
 // If you need functionality from a higher layer, add an extension point in this layer instead.
@@ -15,8 +16,11 @@ export import out.core;
 export import out.domain;
 export import out.format;
 export import out.logger;
+export import out.otlp;
 export import out.port;
+export import out.posix;
 export import out.sink;
+export import out.tee;
 
 #if defined(OUT_ERROR_PROPAGATE)
 #define OUT_API_NODISCARD [[nodiscard]]
@@ -25,21 +29,92 @@ export import out.sink;
 #endif
 
 export namespace out {
+    namespace detail {
+        // Sink held by the loggers built here. With OUT_ERASED_SINK every sink is
+        // reached through sink_view, so formatting is instantiated once per format
+        // string instead of once per sink type (trades an indirect call per write).
+#if defined(OUT_ERASED_SINK)
+        template <class S>
+        using api_sink_t = sink_view;
+#else
+        template <class S>
+        using api_sink_t = sink_ref<S>;
+#endif
+
+        template <class S>
+        constexpr api_sink_t<S> api_sink(S* s) noexcept {
+#if defined(OUT_ERASED_SINK)
+            return sink_view{*s};
+#else
+            return sink_ref<S>{s};
+#endif
+        }
+
+        template <level L, class Domain>
+        inline auto& routed_primary() noexcept {
+            constexpr auto primary = domain_level_sink<Domain, L>;
+            if constexpr (primary != nullptr) {
+                return *primary;
+            } else {
+                return port::default_console();
+            }
+        }
+
+        // Fan-out for a domain_also_sink route, kept in static storage (one per
+        // Domain/level/color) so loggers reach it through a plain reference like
+        // any other sink. With Color the primary child is wrapped in
+        // ansi_sink_ref<..., true>, so logc() keeps console colors; the extra
+        // target gets ANSI only if it has write_ansi itself.
+        // Per-record selection state lives in the tee: same threading rules as the
+        // routed sinks.
+        template <level L, class Domain, bool Color>
+        inline auto& routed_tee() noexcept {
+            auto& p = routed_primary<L, Domain>();
+            using P = std::remove_reference_t<decltype(p)>;
+            using A = std::remove_pointer_t<decltype(domain_also_sink<Domain, L>)>;
+            if constexpr (Color) {
+                static ansi::ansi_sink_ref<P, true> colored{&p};
+                static tee_sink<ansi::ansi_sink_ref<P, true>, A> tee{colored, *domain_also_sink<Domain, L>};
+                return tee;
+            } else {
+                static tee_sink<P, A> tee{p, *domain_also_sink<Domain, L>};
+                return tee;
+            }
+        }
+
+        template <level L, class Domain, bool Color>
+        inline auto routed_tee_logger() noexcept {
+            auto& tee = routed_tee<L, Domain, Color>();
+            using T = std::remove_reference_t<decltype(tee)>;
+            return logger<L, Domain, api_sink_t<T>>{api_sink(&tee)};
+        }
+    }
+
+    // Sinkless entry points follow the compile-time routing table
+    // (domain_sink / domain_level_sink / domain_also_sink in out.domain).
     template <level L, class Domain = default_domain>
     inline auto log() noexcept {
-        return logger<L, Domain, detail::sink_ref<port::console_sink>>{
-            detail::sink_ref<port::console_sink>{&port::default_console()}
-        };
+        constexpr auto primary = domain_level_sink<Domain, L>;
+        if constexpr (domain_also_sink<Domain, L> != nullptr) {
+            return detail::routed_tee_logger<L, Domain, false>();
+        } else if constexpr (primary != nullptr) {
+            using P = std::remove_pointer_t<decltype(primary)>;
+            return logger<L, Domain, detail::api_sink_t<P>>{detail::api_sink(primary)};
+        } else {
+            return logger<L, Domain, detail::api_sink_t<port::console_sink>>{
+                detail::api_sink(&port::default_console())
+            };
+        }
     }
 
     template <level L, class Domain = default_domain, class S>
     inline auto log(S& s) noexcept {
-        return logger<L, Domain, detail::sink_ref<S>>{detail::sink_ref<S>{&s}};
+        return logger<L, Domain, detail::api_sink_t<S>>{detail::api_sink(&s)};
     }
 
     inline auto raw() noexcept {
-        auto out = logger<level::info, default_domain, detail::sink_ref<port::console_sink>, true>{
-            detail::sink_ref<port::console_sink>{&port::default_console()}
+        auto out = logger<level::info, default_domain, detail::api_sink_t<port::console_sink>, true>{
+            detail::api_sink(&port::default_console())
         };
         out.level_prefix(false);
         out.domain_prefix(false);
@@ -49,8 +124,8 @@ export namespace out {
 
     template <class S>
     inline auto raw(S& s) noexcept {
-        auto out = logger<level::info, default_domain, detail::sink_ref<S>, true>{
-            detail::sink_ref<S>{&s}
+        auto out = logger<level::info, default_domain, detail::api_sink_t<S>, true>{
+            detail::api_sink(&s)
         };
         out.level_prefix(false);
         out.domain_prefix(false);
@@ -60,7 +135,12 @@ export namespace out {
 
     template <level L, class Domain = default_domain>
     inline auto logc() noexcept {
-        return log<L, Domain>().template ansi<true>();
+        if constexpr (domain_also_sink<Domain, L> != nullptr) {
+            // The colored tee is already ANSI-aware; see detail::routed_tee.
+            return detail::routed_tee_logger<L, Domain, true>();
+        } else {
+            return log<L, Domain>().template ansi<true>();
+        }
     }
 
     template <level L, class Domain = default_domain, class S>
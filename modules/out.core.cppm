@@ -21,14 +21,71 @@ export namespace out {
         ok = 0,
         io_error,
         // io_fault,
-        // would_block,
+        would_block,  // transient back-pressure from a non-blocking sink; never fatal
         buffer_overflow,
         invalid_format,
         not_supported,
     };
 
+#if defined(OUT_PACKED_RESULT)
+    // Word-sized result<std::size_t>: one size_t whose top 255 values encode the
+    // errc, so it is trivially copyable and returned in a register on every ABI,
+    // and has_value() / forwarding an error are a single compare. Mirrors the
+    // part of std::expected the library uses (values above max_value are not
+    // representable; errc::ok is not a valid error).
+    class packed_result {
+      public:
+        using value_type = std::size_t;
+        using error_type = errc;
+        using unexpected_type = std::unexpected<errc>;
+
+        static constexpr std::size_t max_value = ~std::size_t{0} - 255u;
+
+        constexpr packed_result() noexcept = default;
+        constexpr packed_result(std::in_place_t, std::size_t v) noexcept : bits(v) {}
+        constexpr packed_result(std::unexpected<errc> e) noexcept
+            : bits(max_value + static_cast<std::uint8_t>(e.error())) {}
+
+        template <class U>
+          requires std::is_integral_v<U>
+        constexpr packed_result(U v) noexcept : bits(static_cast<std::size_t>(v)) {}
+
+        template <class U>
+          requires std::is_convertible_v<U, std::size_t>
+        constexpr packed_result(const std::expected<U, errc>& e) noexcept
+            : bits(e ? static_cast<std::size_t>(*e) : max_value + static_cast<std::uint8_t>(e.error())) {}
+
+        constexpr bool has_value() const noexcept { return bits <= max_value; }
+        constexpr explicit operator bool() const noexcept { return has_value(); }
+        constexpr std::size_t operator*() const noexcept { return bits; }
+        constexpr std::size_t value_or(std::size_t v) const noexcept { return has_value() ? bits : v; }
+        constexpr errc error() const noexcept {
+            return has_value() ? errc::ok : static_cast<errc>(bits - max_value);
+        }
+
+        friend constexpr bool operator==(packed_result, packed_result) noexcept = default;
+
+      private:
+        std::size_t bits = 0;
+    };
+#endif
+
+    // result<T> is std::expected<T, errc>; result_select is the extension point
+    // for a leaner representation of a particular T (OUT_PACKED_RESULT).
+    template <class T>
+    struct result_select { using type = std::expected<T, errc>; };
+
+#if defined(OUT_PACKED_RESULT)
+    template <>
+    struct result_select<std::size_t> { using type = packed_result; };
+
+    // Not deducible through the alias; generic code deduces R and uses R::value_type.
+    template <class T>
+    using result = typename result_select<T>::type;
+#else
     template <class T>
     using result = std::expected<T, errc>;
+#endif
 
     using bytes = std::span<const std::byte>;
     using cbytes = std::span<const char>;
@@ -47,6 +104,22 @@ export namespace out {
         return result<std::remove_cvref_t<T>>{std::in_place, std::forward<T>(v)};
     }
 
+    namespace detail {
+        // Byte-count accumulator of the formatting pipeline (vprint, logger records).
+        // With OUT_NO_BYTE_COUNT only success/errc is tracked: the additions compile
+        // out and those paths report 0 bytes; the result<std::size_t> shape stays.
+        struct tally {
+#if defined(OUT_NO_BYTE_COUNT)
+            constexpr void add(std::size_t) noexcept {}
+            constexpr std::size_t get() const noexcept { return 0; }
+#else
+            std::size_t n = 0;
+            constexpr void add(std::size_t v) noexcept { n += v; }
+            constexpr std::size_t get() const noexcept { return n; }
+#endif
+        };
+    }
+
     // Lazy wrapper for deferred evaluation.
     template <class F>
     struct lazy_t { F f; };
@@ -67,10 +140,14 @@ export namespace out {
     constexpr decltype(auto) eval(lazy_t<F>&& lz) { return lz.f(); }
 
     template <class T>
-    constexpr void discard(result<T>&&) noexcept {}
+    constexpr void discard(std::expected<T, errc>&&) noexcept {}
 
     template <class T>
-    constexpr void discard(const result<T>&) noexcept {}
+    constexpr void discard(const std::expected<T, errc>&) noexcept {}
+
+#if defined(OUT_PACKED_RESULT)
+    constexpr void discard(packed_result) noexcept {}
+#endif
 
     // Trait: whether ANSI sequences can be treated as plain bytes for a sink.
     template <class S>
@@ -46,4 +46,21 @@ export namespace out {
     template <class Domain>
     inline constexpr std::string_view domain_name{};
 
+    // 域路由表：编译期把域绑定到目标 Sink 的地址（nullptr = 默认控制台），
+    // out::log<L, Domain>() 在编译期解析，不产生运行时分派。显式传入 Sink 的调用不受影响。
+    // 用法示例：
+    // template <> inline constexpr auto domain_sink<net_domain> = &uart2;
+    template <class Domain>
+    inline constexpr auto domain_sink = nullptr;
+
+    // 按级别覆盖目标 Sink（默认沿用 domain_sink<Domain>）：
+    // template <> inline constexpr auto domain_level_sink<net_domain, level::trace> = &trace_buf;
+    template <class Domain, level L>
+    inline constexpr auto domain_level_sink = domain_sink<Domain>;
+
+    // 按级别追加的 Sink：记录一次格式化，同时写入两处（例如 error 另写 stderr）；nullptr = 不追加
+    // template <> inline constexpr auto domain_also_sink<net_domain, level::error> = &stderr_sink;
+    template <class Domain, level L>
+    inline constexpr auto domain_also_sink = nullptr;
+
 }
@@ -5,6 +5,7 @@ module;
 #include <charconv>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <string_view>
 #include <tuple>
 #include <type_traits>
@@ -19,6 +20,13 @@ export module out.format;
 import out.core;
 import out.sink;
 
+// Keeps the shared OUT_BYTECODE interpreter out of line at every call site.
+#if defined(__GNUC__)
+#define OUT_FORMAT_NOINLINE [[gnu::noinline]]
+#else
+#define OUT_FORMAT_NOINLINE
+#endif
+
 
 export namespace out {
 
@@ -181,10 +189,36 @@ export namespace out {
       return res;
     }
 
+    // Single scan into an upper-bound token array: every token covers at least
+    // one character of F, so F.size() tokens always suffice. parse_format()
+    // then copies the used prefix into an exactly sized parsed_format.
+    template <fixed_string F>
+    struct scanned_format {
+      std::array<token, F.size()> toks{};
+      scan_result r{};
+      bool overflow = false;
+    };
+
+    template <fixed_string F>
+    consteval scanned_format<F> scan_bounded() {
+      scanned_format<F> out{};
+      std::size_t k = 0;
+      bool overflow = false;
+      out.r = scan_format<F>([&](const token& tk) {
+        // 理论上永远不应该越界；越界说明上界估计与 scan_format 逻辑不一致
+        if (k >= out.toks.size()) { overflow = true; return; }
+        out.toks[k++] = tk;
+      });
+      out.overflow = overflow;
+      return out;
+    }
+
+    template <fixed_string F>
+    inline constexpr scanned_format<F> scanned_v = scan_bounded<F>();
+
     template <fixed_string F>
     consteval std::size_t token_count() {
-      auto r = scan_format<F>([](const token&) {});
-      return r.ntok;
+      return scanned_v<F>.r.ntok;
     }
 
   } // namespace detail
@@ -199,18 +233,12 @@ export namespace out {
 
   template <fixed_string F>
   consteval auto parse_format() {
-    constexpr std::size_t NTok = detail::token_count<F>();
-    parsed_format<F, NTok> out{};
-
-    std::size_t k = 0;
-    auto r = detail::scan_format<F>([&](const token& tk) {
-      // 理论上永远不应该越界；越界说明 token_count 与 scan_format 逻辑不一致
-      if (k >= NTok) { out.valid = false; return; }
-      out.toks[k++] = tk;
-    });
-
-    out.valid = out.valid && r.valid && (k == NTok);
-    out.nargs = r.nargs;
+    constexpr auto& sc = detail::scanned_v<F>;
+    parsed_format<F, sc.r.ntok> out{};
+    for (std::size_t k = 0; k < sc.r.ntok && k < sc.toks.size(); ++k) out.toks[k] = sc.toks[k];
+
+    out.valid = sc.r.valid && !sc.overflow;
+    out.nargs = sc.r.nargs;
     return out;
   }
 
@@ -219,13 +247,91 @@ export namespace out {
     template <fixed_string Fmt>
     inline constexpr auto parsed_v = parse_format<Fmt>();
 
-    template <class S, std::size_t N>
+#if defined(OUT_BYTECODE)
+    // ---------- OUT_BYTECODE: format string compiled to a byte program ----------
+    // lit:      [bc_lit][len][len bytes]            (literal runs split at 255 bytes)
+    // arg:      [bc_arg][index]                     (default spec)
+    // arg+spec: [bc_arg_spec][index][type][width][precision][flags: zero_pad | upper << 1]
+    inline constexpr unsigned char bc_lit = 0;
+    inline constexpr unsigned char bc_arg = 1;
+    inline constexpr unsigned char bc_arg_spec = 2;
+
+    consteval bool is_default_spec(const fmt_spec& s) {
+      return s.type == 0 && s.width == 0 && s.precision == 0xFF && !s.zero_pad && !s.upper;
+    }
+
+    template <class PF>
+    consteval std::size_t bytecode_size(const PF& pf) {
+      std::size_t n = 0;
+      for (const auto& tk : pf.toks) {
+        if (tk.kind == token_kind::lit) {
+          n += tk.len + 2 * ((tk.len + 254) / 255);
+        } else {
+          n += is_default_spec(tk.spec) ? 2 : 6;
+        }
+      }
+      return n;
+    }
+
+    template <fixed_string Fmt>
+    consteval auto compile_bytecode() {
+      constexpr auto& pf = parsed_v<Fmt>;
+      std::array<unsigned char, bytecode_size(pf)> code{};
+      std::size_t k = 0;
+      for (const auto& tk : pf.toks) {
+        if (tk.kind == token_kind::lit) {
+          std::size_t pos = tk.pos;
+          std::size_t left = tk.len;
+          while (left != 0) {
+            const std::size_t n = (left > 255) ? 255 : left;
+            code[k++] = bc_lit;
+            code[k++] = static_cast<unsigned char>(n);
+            for (std::size_t i = 0; i < n; ++i) code[k++] = static_cast<unsigned char>(pf.text[pos + i]);
+            pos += n;
+            left -= n;
+          }
+        } else if (is_default_spec(tk.spec)) {
+          code[k++] = bc_arg;
+          code[k++] = tk.arg_index;
+        } else {
+          code[k++] = bc_arg_spec;
+          code[k++] = tk.arg_index;
+          code[k++] = static_cast<unsigned char>(tk.spec.type);
+          code[k++] = tk.spec.width;
+          code[k++] = tk.spec.precision;
+          code[k++] = static_cast<unsigned char>((tk.spec.zero_pad ? 1 : 0) | (tk.spec.upper ? 2 : 0));
+        }
+      }
+      return code;
+    }
+
+    template <fixed_string Fmt>
+    inline constexpr auto bytecode_v = compile_bytecode<Fmt>();
+#endif
+
+    // Overflow storage for a record longer than a buffered_writer window. While
+    // attached, full windows are moved here instead of being written, and the
+    // final flush() delivers the whole record as one write (see the logger's
+    // OUT_LOGGER_SPILL_SIZE). busy marks the arena as owned by a record.
+    struct spill_arena {
+      char* data = nullptr;
+      std::size_t cap = 0;
+      std::size_t len = 0;
+      bool busy = false;
+    };
+
+    struct no_spill {};
+
+    // Spill selects a writer that can attach a spill_arena; without it the
+    // member is empty and the spill branches are not compiled.
+    template <class S, std::size_t N, bool Spill = false>
     struct buffered_writer {
       S& sink;
       std::array<char, N> buf{};
       std::size_t pos = 0;
       std::array<char, 64> ansi_buf{};
       std::size_t ansi_pos = 0;
+      [[no_unique_address]] std::conditional_t<Spill, spill_arena*, no_spill> spill{};
 
       result<std::size_t> flush_ansi() noexcept {
         if constexpr (ansi_is_bytes_final_v<S>) {
@@ -243,9 +349,32 @@ export namespace out {
         }
       }
 
+      // Moves the window into the spill arena; false without an arena or room.
+      bool stash() noexcept {
+        if constexpr (Spill) {
+          if (spill == nullptr || spill->cap - spill->len < pos) return false;
+          std::memcpy(spill->data + spill->len, buf.data(), pos);
+          spill->len += pos;
+          pos = 0;
+          return true;
+        } else {
+          return false;
+        }
+      }
+
+      // Writes the window; spilled bytes go first, joined with the window into
+      // a single write when it still fits in the arena.
       result<std::size_t> flush_bytes() noexcept {
-        if (pos == 0) return ok<std::size_t>(0u);
         const std::size_t n = pos;
+        if constexpr (Spill) {
+          if (spill != nullptr && spill->len != 0) {
+            (void)stash();
+            auto r = out::write(sink, std::string_view{spill->data, spill->len});
+            spill->len = 0;
+            if (!r) return std::unexpected(r.error());
+          }
+        }
+        if (pos == 0) return ok(n);
         auto r = out::write(sink, std::string_view{buf.data(), pos});
         if (!r) return std::unexpected(r.error());
         pos = 0;
@@ -266,11 +395,31 @@ export namespace out {
           if (!ra) return std::unexpected(ra.error());
         }
         const std::size_t len = sv.size();
+        // Views of at least a whole buffer go to the sink by reference after the
+        // pending bytes (pending ANSI was flushed above), so order is kept and the
+        // payload is not copied through the window.
+        if (len >= N) {
+          if constexpr (Spill) {
+            if (spill != nullptr && spill->cap - spill->len >= pos + len) {
+              (void)stash();
+              std::memcpy(spill->data + spill->len, sv.data(), len);
+              spill->len += len;
+              return ok(len);
+            }
+          }
+          auto rb = flush_bytes();
+          if (!rb) return std::unexpected(rb.error());
+          auto r = out::write(sink, sv);
+          if (!r) return std::unexpected(r.error());
+          return ok(len);
+        }
         while (!sv.empty()) {
           std::size_t space = N - pos;
           if (space == 0) {
-            auto r = flush_bytes();
-            if (!r) return std::unexpected(r.error());
+            if (!stash()) {
+              auto r = flush_bytes();
+              if (!r) return std::unexpected(r.error());
+            }
             space = N;
           }
           const std::size_t n = (sv.size() < space) ? sv.size() : space;
@@ -311,8 +460,8 @@ export namespace out {
     template <class T>
     struct is_buffered_writer : std::false_type {};
 
-    template <class S, std::size_t N>
-    struct is_buffered_writer<buffered_writer<S, N>> : std::true_type {};
+    template <class S, std::size_t N, bool Spill>
+    struct is_buffered_writer<buffered_writer<S, N, Spill>> : std::true_type {};
 
     template <class T>
     inline constexpr bool is_buffered_writer_v = is_buffered_writer<T>::value;
@@ -330,8 +479,8 @@ export namespace out {
       }
     }
 
-    template <auto& PF, std::size_t I, class S, class Tup, std::size_t N>
-    inline result<std::size_t> emit_token_buffered(buffered_writer<S, N>& bw, Tup& tup) noexcept {
+    template <auto& PF, std::size_t I, class S, class Tup, std::size_t N, bool Spill>
+    inline result<std::size_t> emit_token_buffered(buffered_writer<S, N, Spill>& bw, Tup& tup) noexcept {
       constexpr token tk = PF.toks[I];
 
       if constexpr (tk.kind == token_kind::lit) {
@@ -343,23 +492,23 @@ export namespace out {
       }
     }
 
-    template <auto& PF, class S, class Tup, std::size_t N, std::size_t... Is>
+    template <auto& PF, class S, class Tup, std::size_t N, bool Spill, std::size_t... Is>
     inline result<std::size_t> unroll_tokens_seq(
-        buffered_writer<S, N>& bw, Tup& tup, std::index_sequence<Is...>) noexcept {
-      std::size_t total = 0;
+        buffered_writer<S, N, Spill>& bw, Tup& tup, std::index_sequence<Is...>) noexcept {
+      tally total;
       errc first_err = errc::ok;
       bool ok_all = true;
 
       auto step = [&](auto r) {
         if (!ok_all) return;
         if (!r) { ok_all = false; first_err = r.error(); return; }
-        total += *r;
+        total.add(*r);
       };
 
       (step(emit_token_buffered<PF, Is>(bw, tup)), ...);
 
       if (!ok_all) return std::unexpected(first_err);
-      return ok(total);
+      return ok(total.get());
     }
 
   } // namespace detail
@@ -789,6 +938,140 @@ namespace detail {
     }
   }
 
+#if defined(OUT_BYTECODE)
+  namespace detail {
+
+    // Type-erased argument for the bytecode interpreter. Built-in kinds carry the
+    // value; everything else (formatter<T>, style tokens) keeps a pointer and a
+    // per-(writer, type) thunk so it is still formatted against the real sink.
+    struct packed_arg {
+      enum class kind : std::uint8_t { chr, str, boolean, i32, u32, i64, u64, flt, custom };
+      kind k = kind::custom;
+      union {
+        std::uint32_t u32;
+        std::uint64_t u64;
+        float f;
+        struct { const char* p; std::size_t n; } s;
+        const void* obj;
+      };
+      result<std::size_t> (*fmt)(void*, const void*, fmt_spec) noexcept = nullptr;
+
+      constexpr packed_arg() noexcept : u64(0) {}
+    };
+
+    template <class W, class T>
+    inline result<std::size_t> write_erased(void* w, const void* v, fmt_spec spec) noexcept {
+      return write_one(*static_cast<W*>(w), *static_cast<const T*>(v), spec);
+    }
+
+    // Mirrors the type dispatch order of write_one.
+    template <class W, class T>
+    inline packed_arg pack_arg(const T& v) noexcept {
+      using K = packed_arg::kind;
+      packed_arg a{};
+      if constexpr (std::is_same_v<T, char>) {
+        a.k = K::chr;
+        a.u32 = static_cast<unsigned char>(v);
+      } else if constexpr (std::is_convertible_v<T, std::string_view>) {
+        const std::string_view sv(v);
+        a.k = K::str;
+        a.s = {sv.data(), sv.size()};
+      } else if constexpr (std::is_same_v<T, bool>) {
+        a.k = K::boolean;
+        a.u32 = v ? 1u : 0u;
+#ifdef OUT_ENABLE_FLOAT
+      } else if constexpr (std::is_same_v<T, float>) {
+        a.k = K::flt;
+        a.f = v;
+#endif
+      } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+        using Raw = enum_underlying_or_self_t<T>;
+        const Raw rv = static_cast<Raw>(v);
+        if constexpr (sizeof(Raw) <= 4) {
+          a.k = std::is_signed_v<Raw> ? K::i32 : K::u32;
+          a.u32 = static_cast<std::uint32_t>(rv);
+        } else {
+          a.k = std::is_signed_v<Raw> ? K::i64 : K::u64;
+          a.u64 = static_cast<std::uint64_t>(rv);
+        }
+      } else {
+        a.obj = std::addressof(v);
+        a.fmt = &write_erased<W, T>;
+      }
+      return a;
+    }
+
+    // Byte sink the interpreter writes through: one indirect call per write.
+    struct bc_sink {
+      void* ctx;
+      result<std::size_t> (*fn)(void*, bytes) noexcept;
+      result<std::size_t> write(bytes b) noexcept { return fn(ctx, b); }
+    };
+
+    template <class W>
+    inline result<std::size_t> bc_write(void* w, bytes b) noexcept {
+      return static_cast<W*>(w)->write(b);
+    }
+
+    inline result<std::size_t> write_packed(bc_sink& out, const packed_arg& a, fmt_spec spec) noexcept {
+      using K = packed_arg::kind;
+      switch (a.k) {
+        case K::chr: return write_one(out, static_cast<char>(a.u32), spec);
+        case K::str: return write_one(out, std::string_view{a.s.p, a.s.n}, spec);
+        case K::boolean: return write_one(out, a.u32 != 0, spec);
+        case K::i32: return write_one(out, static_cast<std::int32_t>(a.u32), spec);
+        case K::u32: return write_one(out, a.u32, spec);
+        case K::i64: return write_one(out, static_cast<std::int64_t>(a.u64), spec);
+        case K::u64: return write_one(out, a.u64, spec);
+#ifdef OUT_ENABLE_FLOAT
+        case K::flt: return write_one(out, a.f, spec);
+#endif
+        default: return a.fmt(out.ctx, a.obj, spec);
+      }
+    }
+
+    // The single shared interpreter: every format string and argument list
+    // ends up here, so a call site only costs packing its arguments.
+    OUT_FORMAT_NOINLINE inline result<std::size_t> run_bytecode(
+        const unsigned char* pc, const unsigned char* end, const packed_arg* args, bc_sink& out) noexcept {
+      tally total;
+      while (pc != end) {
+        const unsigned char op = *pc++;
+        result<std::size_t> r = ok<std::size_t>(0u);
+        if (op == bc_lit) {
+          const std::size_t n = *pc++;
+          r = write(out, std::string_view{reinterpret_cast<const char*>(pc), n});
+          pc += n;
+        } else {
+          const packed_arg& a = args[*pc++];
+          fmt_spec spec{};
+          if (op == bc_arg_spec) {
+            spec.type = static_cast<char>(pc[0]);
+            spec.width = pc[1];
+            spec.precision = pc[2];
+            spec.zero_pad = (pc[3] & 1) != 0;
+            spec.upper = (pc[3] & 2) != 0;
+            pc += 4;
+          }
+          r = write_packed(out, a, spec);
+        }
+        if (!r) return std::unexpected(r.error());
+        total.add(*r);
+      }
+      return ok(total.get());
+    }
+
+    template <fixed_string Fmt, class W, class... Args>
+    inline result<std::size_t> run_packed(W& w, const Args&... args) noexcept {
+      constexpr auto& code = bytecode_v<Fmt>;
+      const packed_arg packed[sizeof...(Args) + 1] = {pack_arg<W>(args)..., packed_arg{}};
+      bc_sink out{std::addressof(w), &bc_write<W>};
+      return run_bytecode(code.data(), code.data() + code.size(), packed, out);
+    }
+
+  } // namespace detail
+#endif
+
   // format 输出：编译期解析 + runtime 展开
   /* TODO: vprint() 运行时 for-loop + idx 分派可以进一步“编译期展开 token”
    * 现在的 vprint() 是：
@@ -825,18 +1108,46 @@ namespace detail {
       "float formatting spec requested (use {:f}/{:e}/{:g}) but OUT_ENABLE_FLOAT is not defined");
 #endif
 
+#if defined(OUT_BYTECODE)
+    // Bytecode mode (takes precedence over OUT_UNROLL_TOKENS): arguments are packed
+    // and the shared interpreter runs the format's compiled program.
+    if constexpr (detail::is_buffered_writer_v<S>) {
+      auto r = detail::run_packed<Fmt>(sink, args...);
+      if (!r) return std::unexpected(r.error());
+      detail::tally total;
+      total.add(*r);
+      if constexpr (FinalFlush) {
+        auto rf = sink.flush();
+        if (!rf) return std::unexpected(rf.error());
+        total.add(*rf);
+      }
+      return ok(total.get());
+    } else {
+      detail::buffered_writer<S, OUT_WRITE_BUFFER_SIZE> bw{sink};
+      auto r = detail::run_packed<Fmt>(bw, args...);
+      if (!r) return std::unexpected(r.error());
+      detail::tally total;
+      total.add(*r);
+      if constexpr (FinalFlush) {
+        auto rf = bw.flush();
+        if (!rf) return std::unexpected(rf.error());
+        total.add(*rf);
+      }
+      return ok(total.get());
+    }
+#else
     // 参数打包成 tuple 方便按索引取
     auto tup = std::forward_as_tuple(std::forward<Args>(args)...);
 
     if constexpr (detail::is_buffered_writer_v<S>) {
-      std::size_t total = 0;
+      detail::tally total;
 
 #if defined(OUT_UNROLL_TOKENS)
       if constexpr (pf.toks.size() <= OUT_UNROLL_TOKENS_MAX) {
         auto r = detail::unroll_tokens_seq<detail::parsed_v<Fmt>>(
           sink, tup, std::make_index_sequence<pf.toks.size()>{});
         if (!r) return std::unexpected(r.error());
-        total += *r;
+        total.add(*r);
       } else {
         for (std::size_t i = 0; i < pf.toks.size(); ++i) {
           const auto& tk = pf.toks[i];
@@ -844,7 +1155,7 @@ namespace detail {
             auto sv = pf.text.substr(tk.pos, tk.len);
             auto r = sink.append(sv);
             if (!r) return std::unexpected(r.error());
-            total += *r;
+            total.add(*r);
           } else {
             // ?????????
             auto idx = tk.arg_index;
@@ -856,7 +1167,7 @@ namespace detail {
             }(std::make_index_sequence<sizeof...(Args)>{});
 
             if (!r) return std::unexpected(r.error());
-            total += *r;
+            total.add(*r);
           }
         }
       }
@@ -867,7 +1178,7 @@ namespace detail {
           auto sv = pf.text.substr(tk.pos, tk.len);
           auto r = sink.append(sv);
           if (!r) return std::unexpected(r.error());
-          total += *r;
+          total.add(*r);
         } else {
           // ?????????
           auto idx = tk.arg_index;
@@ -879,16 +1190,16 @@ namespace detail {
           }(std::make_index_sequence<sizeof...(Args)>{});
 
           if (!r) return std::unexpected(r.error());
-          total += *r;
+          total.add(*r);
         }
       }
 #endif
       if constexpr (FinalFlush) {
         auto rf = sink.flush();
         if (!rf) return std::unexpected(rf.error());
-        total += *rf;
+        total.add(*rf);
       }
-      return ok(total);
+      return ok(total.get());
     } else {
 #if defined(OUT_UNROLL_TOKENS)
     if constexpr (pf.toks.size() <= OUT_UNROLL_TOKENS_MAX) {
@@ -896,24 +1207,25 @@ namespace detail {
       auto r = detail::unroll_tokens_seq<detail::parsed_v<Fmt>>(
         bw, tup, std::make_index_sequence<pf.toks.size()>{});
       if (!r) return std::unexpected(r.error());
-      std::size_t total = *r;
+      detail::tally total;
+      total.add(*r);
       if constexpr (FinalFlush) {
         auto rf = bw.flush();
         if (!rf) return std::unexpected(rf.error());
-        total += *rf;
+        total.add(*rf);
       }
-      return ok(total);
+      return ok(total.get());
     }
 #endif
     detail::buffered_writer<S, OUT_WRITE_BUFFER_SIZE> bw{sink};
-    std::size_t total = 0;
+    detail::tally total;
     for (std::size_t i = 0; i < pf.toks.size(); ++i) {
       const auto& tk = pf.toks[i];
       if (tk.kind == token_kind::lit) {
         auto sv = pf.text.substr(tk.pos, tk.len);
         auto r = bw.append(sv);
         if (!r) return std::unexpected(r.error());
-        total += *r;
+        total.add(*r);
       } else {
         // ?????????
         auto idx = tk.arg_index;
@@ -925,16 +1237,29 @@ namespace detail {
         }(std::make_index_sequence<sizeof...(Args)>{});
 
         if (!r) return std::unexpected(r.error());
-        total += *r;
+        total.add(*r);
       }
     }
     if constexpr (FinalFlush) {
       auto rf = bw.flush();
       if (!rf) return std::unexpected(rf.error());
-      total += *rf;
+      total.add(*rf);
     }
-    return ok(total);
+    return ok(total.get());
   }
+#endif
+  }
+
+  // Composition helper for formatter<T>::write: formats straight into the writer
+  // the formatter was handed. Inside vprint and the logger that is the parent
+  // buffered_writer, so tokens are appended in place (no second buffer, no
+  // intermediate flush) however deeply formatters nest; any other sink goes
+  // through the regular vprint.
+  template <fixed_string Fmt, Sink S, class... Args>
+  inline result<std::size_t> format_into(S& ctx, Args&&... args) noexcept {
+    return vprint<Fmt, S, !detail::is_buffered_writer_v<S>>(ctx, std::forward<Args>(args)...);
   }
 
 }
+
+#undef OUT_FORMAT_NOINLINE
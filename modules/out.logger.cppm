@@ -1,5 +1,6 @@
 ﻿module;
 #include <array>
+#include <bit>
 #include <cstdint>
 #include <cstdlib>
 #include <charconv>
@@ -8,6 +9,9 @@
 #include <type_traits>
 #include <utility>
 #include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 export module out.logger;
 // Dependency contract (DO NOT VIOLATE)
 // Allowed out.* imports: out.core, out.sink, out.format, out.domain, out.port, out.ansi
@@ -32,6 +36,13 @@ import out.sink;
 #define OUT_LOGGER_WRITE_BUFFER_SIZE 128
 #endif
 
+// Spill arena for records longer than the write buffer: a record that
+// overflows continues there and reaches the sink as one write. One arena per
+// thread (thread_local), or a single static one with OUT_NO_TLS. 0 = off.
+#ifndef OUT_LOGGER_SPILL_SIZE
+#define OUT_LOGGER_SPILL_SIZE 0
+#endif
+
 export namespace out {
 
     enum class error_policy : std::uint8_t { ignore, hook, assert_, propagate };
@@ -76,6 +87,187 @@ export namespace out {
         return {};
     }
 
+    // Optional record metadata hook: sinks that map level/domain onto their own
+    // protocol (syslog priority, journald fields...) receive them before the bytes.
+    template <class S>
+    concept RecordMetaSink = requires(S& s, level l, std::string_view d) {
+        s.begin_record(l, d);
+    };
+
+#if defined(OUT_NO_BYTE_COUNT)
+    namespace detail {
+        // flush_policy::every_bytes with OUT_NO_BYTE_COUNT: records report 0 bytes,
+        // so a byte budget could never fire. Setting one does not compile.
+        struct no_byte_budget {
+            constexpr no_byte_budget() noexcept = default;
+            template <class T>
+            constexpr no_byte_budget(T) noexcept {
+                static_assert(!std::is_same_v<T, T>,
+                              "flush_policy::every_bytes needs byte counting (OUT_NO_BYTE_COUNT is defined)");
+            }
+        };
+    }
+#endif
+
+    // Flush coalescing. Instead of flushing the sink after every line, a logger
+    // bound to a policy (logger::flush_with) flushes when one of the triggers
+    // fires. Point every logger that targets the same sink at the same policy
+    // object so the byte/time budgets are counted across all of them.
+    // The time trigger is evaluated when a record is emitted and by
+    // logger::poll(); there is no timer, so call poll() from an idle loop or
+    // tick if quiet periods must still flush.
+    // Not synchronised: the fields are plain members updated on every record.
+    // Share one policy only among loggers that already serialise access to the
+    // sink (one thread, or the lock that guards the sink); otherwise give each
+    // thread its own.
+    struct flush_policy {
+#if defined(OUT_NO_BYTE_COUNT)
+        detail::no_byte_budget every_bytes; // unavailable: records carry no byte count
+#else
+        std::size_t every_bytes = 0;        // flush once this many bytes are pending; 0 = off
+#endif
+        port::tick_t every_ms = 0;          // flush if the last flush is older than this; 0 = off
+        level at_level = level::warn;       // records at or above this severity flush immediately
+        std::size_t pending = 0;
+        port::tick_t last_ms = 0;           // valid once timed is set
+        bool timed = false;                 // every_ms clock started (first record or poll)
+        bool requested = false;
+        bool dirty = false;                 // records written since the last flush
+        bool in_record = false;             // a bound logger is emitting a record
+        void* target = nullptr;             // sink bound by logger::flush_with, if any
+        result<std::size_t> (*flush_fn)(void*) noexcept = nullptr;
+
+        // Flushes the bound sink now unless a record is being emitted; otherwise
+        // (or with no bound sink) the next record or poll() flushes instead.
+        result<std::size_t> request() noexcept {
+            if (!flush_fn || in_record) {
+                requested = true;
+                return ok<std::size_t>(0u);
+            }
+            mark_flushed();
+            return flush_fn(target);
+        }
+
+        // Accounts for an n-byte record at level l; true when the sink should flush now.
+        bool on_record(level l, std::size_t n) noexcept {
+            pending += n;
+            dirty = true;
+            bool due = requested || (l != level::off && l <= at_level);
+#if !defined(OUT_NO_BYTE_COUNT)
+            due = due || (every_bytes != 0 && pending >= every_bytes);
+#endif
+            if (!due && every_ms != 0) due = deadline_passed();
+            if (due) mark_flushed();
+            return due;
+        }
+
+        // Checks the request flag and the every_ms deadline without a new record;
+        // true when the sink should flush now.
+        bool on_poll() noexcept {
+            bool due = requested || (dirty && every_ms != 0 && deadline_passed());
+            if (due) mark_flushed();
+            return due;
+        }
+
+        void mark_flushed() noexcept {
+            pending = 0;
+            requested = false;
+            dirty = false;
+            if (every_ms != 0) {
+                last_ms = port::now_ms();
+                timed = true;
+            }
+        }
+
+        // The interval counts from the first observation, not from tick 0, so
+        // the first record after boot does not flush just because time started.
+        bool deadline_passed() noexcept {
+            const port::tick_t now = port::now_ms();
+            if (!timed) {
+                last_ms = now;
+                timed = true;
+                return false;
+            }
+            return now - last_ms >= every_ms;
+        }
+    };
+
+    // Type-erased sink: a context pointer plus one function pointer per capability.
+    // A logger over sink_view instantiates the formatter once per format string,
+    // whatever concrete sink is behind it (OUT_ERASED_SINK makes out.api use it).
+    // Always looks ANSI/record/flush capable; missing capabilities are no-ops.
+    // ANSI is a runtime switch with ansi_sink_ref semantics: ansi<true>() writes
+    // escapes to a plain sink as bytes, ansi<false>() drops them. Does not own
+    // the sink; keep it alive as long as the view.
+    struct sink_view {
+        void* ctx = nullptr;
+        result<std::size_t> (*write_fn)(void*, bytes) noexcept = nullptr;
+        result<std::size_t> (*ansi_fn)(void*, std::string_view) noexcept = nullptr;
+        result<std::size_t> (*flush_fn)(void*) noexcept = nullptr;
+        void (*begin_fn)(void*, level, std::string_view) noexcept = nullptr;
+        result<std::size_t> (*end_fn)(void*) noexcept = nullptr;
+        bool ansi_on = false;
+
+        constexpr sink_view() noexcept = default;
+
+        template <Sink S>
+          requires (!std::is_same_v<S, sink_view>)
+        constexpr sink_view(S& s) noexcept
+            : ctx(std::addressof(s)), write_fn(&do_write<S>), ansi_fn(&do_ansi<S>),
+              ansi_on(ansi::AnsiSink<S>) {
+            if constexpr (Flushable<S>) flush_fn = &do_flush<S>;
+            if constexpr (RecordMetaSink<S>) begin_fn = &do_begin<S>;
+            if constexpr (RecordSink<S>) end_fn = &do_end<S>;
+        }
+
+        template <bool Enabled = true>
+        constexpr sink_view ansi() const noexcept {
+            sink_view v = *this;
+            v.ansi_on = Enabled;
+            return v;
+        }
+
+        result<std::size_t> write(bytes b) const noexcept { return write_fn(ctx, b); }
+
+        result<std::size_t> write_ansi(std::string_view sv) const noexcept {
+            if (!ansi_on) return ok<std::size_t>(0u);
+            return ansi_fn(ctx, sv);
+        }
+
+        result<std::size_t> flush() const noexcept {
+            if (!flush_fn) return ok<std::size_t>(0u);
+            return flush_fn(ctx);
+        }
+
+        void begin_record(level l, std::string_view domain) const noexcept {
+            if (begin_fn) begin_fn(ctx, l, domain);
+        }
+
+        result<std::size_t> end_record() const noexcept {
+            if (!end_fn) return ok<std::size_t>(0u);
+            return end_fn(ctx);
+        }
+
+      private:
+        template <class S>
+        static result<std::size_t> do_write(void* c, bytes b) noexcept {
+            return static_cast<S*>(c)->write(b);
+        }
+        template <class S>
+        static result<std::size_t> do_ansi(void* c, std::string_view sv) noexcept {
+            if constexpr (ansi::AnsiSink<S>) return static_cast<S*>(c)->write_ansi(sv);
+            else return out::write(*static_cast<S*>(c), sv);
+        }
+        template <class S>
+        static result<std::size_t> do_flush(void* c) noexcept { return static_cast<S*>(c)->flush(); }
+        template <class S>
+        static void do_begin(void* c, level l, std::string_view d) noexcept {
+            static_cast<S*>(c)->begin_record(l, d);
+        }
+        template <class S>
+        static result<std::size_t> do_end(void* c) noexcept { return static_cast<S*>(c)->end_record(); }
+    };
+
     namespace detail {
         template <class T>
         using public_return_t =
@@ -87,15 +279,15 @@ export namespace out {
             } else if constexpr (build_error_policy == error_policy::hook) {
                 if (error_hook) error_hook(e);
             } else if constexpr (build_error_policy == error_policy::assert_) {
-                (void)e;
-                std::abort();
+                // would_block is back-pressure from a non-blocking sink, not a fault.
+                if (e != errc::would_block) std::abort();
             } else {
                 (void)e;
             }
         }
 
-        template <class T>
-        inline public_return_t<T> finalize(result<T> r) noexcept {
+        template <class R>
+        inline public_return_t<typename R::value_type> finalize(R r) noexcept {
             if constexpr (build_error_policy == error_policy::propagate) {
                 return r;
             } else {
@@ -104,6 +296,128 @@ export namespace out {
             }
         }
 
+        // Index of the first byte a JSON string must escape ('"', '\\', < 0x20), or n.
+        // 16 bytes per step with SSE2, 8 bytes per step (SWAR) elsewhere.
+        inline std::size_t json_special(const char* p, std::size_t n) noexcept {
+            std::size_t i = 0;
+#if defined(__SSE2__)
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i bslash = _mm_set1_epi8('\\');
+            const __m128i ctl = _mm_set1_epi8(0x1F);
+            for (; i + 16 <= n; i += 16) {
+                const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+                const __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, bslash)),
+                                               _mm_cmpeq_epi8(_mm_max_epu8(x, ctl), ctl));
+                if (const int bits = _mm_movemask_epi8(m)) {
+                    return i + static_cast<std::size_t>(std::countr_zero(static_cast<unsigned>(bits)));
+                }
+            }
+#endif
+            constexpr std::uint64_t ones = 0x0101010101010101u;
+            constexpr std::uint64_t high = 0x8080808080808080u;
+            for (; i + 8 <= n; i += 8) {
+                std::uint64_t x;
+                std::memcpy(&x, p + i, sizeof(x));
+                const std::uint64_t xq = x ^ (ones * '"');
+                const std::uint64_t xb = x ^ (ones * '\\');
+                // Per-byte "== 0" / "< 0x20" tests; only bytes above a hit can be false positives.
+                const std::uint64_t m = (((xq - ones) & ~xq) | ((xb - ones) & ~xb) | ((x - ones * 0x20) & ~x)) & high;
+                if (m != 0) {
+                    if constexpr (std::endian::native == std::endian::little) {
+                        return i + static_cast<std::size_t>(std::countr_zero(m)) / 8;
+                    } else {
+                        break;
+                    }
+                }
+            }
+            for (; i < n; ++i) {
+                const auto c = static_cast<unsigned char>(p[i]);
+                if (c == '"' || c == '\\' || c < 0x20) return i;
+            }
+            return n;
+        }
+
+        // Sink adapter that JSON-escapes everything written through it into W.
+        template <class W>
+        struct json_escaper {
+            W& w;
+
+            result<std::size_t> write(bytes b) noexcept {
+                auto p = reinterpret_cast<const char*>(b.data());
+                std::size_t n = b.size();
+                while (n != 0) {
+                    const std::size_t k = json_special(p, n);
+                    if (k != 0) {
+                        auto r = w.append(std::string_view{p, k});
+                        if (!r) return std::unexpected(r.error());
+                    }
+                    if (k == n) break;
+                    const auto c = static_cast<unsigned char>(p[k]);
+                    char e[6] = {'\\', static_cast<char>(c), 0, 0, 0, 0};
+                    std::size_t len = 2;
+                    switch (c) {
+                    case '"': case '\\': break;
+                    case '\n': e[1] = 'n'; break;
+                    case '\r': e[1] = 'r'; break;
+                    case '\t': e[1] = 't'; break;
+                    default:
+                        e[1] = 'u'; e[2] = '0'; e[3] = '0';
+                        e[4] = "0123456789abcdef"[c >> 4];
+                        e[5] = "0123456789abcdef"[c & 0xF];
+                        len = 6;
+                        break;
+                    }
+                    auto r = w.append(std::string_view{e, len});
+                    if (!r) return std::unexpected(r.error());
+                    p += k + 1;
+                    n -= k + 1;
+                }
+                return ok(b.size());
+            }
+        };
+
+        template <class T>
+        inline constexpr bool is_style_token_v =
+            std::is_same_v<T, reset_t> || std::is_same_v<T, bold_t> || std::is_same_v<T, dim_t> ||
+            std::is_same_v<T, italic_t> || std::is_same_v<T, underline_t> ||
+            std::is_same_v<T, ansi::fg_t> || std::is_same_v<T, ansi::bg_t>;
+
+#if OUT_LOGGER_SPILL_SIZE > 0
+        inline spill_arena& logger_spill() noexcept {
+#if defined(OUT_NO_TLS)
+            static char storage[OUT_LOGGER_SPILL_SIZE];
+            static spill_arena arena{storage, sizeof(storage)};
+#else
+            thread_local char storage[OUT_LOGGER_SPILL_SIZE];
+            thread_local spill_arena arena{storage, sizeof(storage)};
+#endif
+            return arena;
+        }
+
+        // Borrows the arena for one record. A nested record (logging from inside a
+        // formatter, or an interrupt with OUT_NO_TLS) finds it busy and streams.
+        struct spill_lease {
+            spill_arena* arena = nullptr;
+
+            spill_lease() noexcept {
+                auto& a = logger_spill();
+                if (!a.busy) {
+                    a.busy = true;
+                    a.len = 0;
+                    arena = &a;
+                }
+            }
+            ~spill_lease() {
+                if (arena) {
+                    arena->len = 0;
+                    arena->busy = false;
+                }
+            }
+            spill_lease(const spill_lease&) = delete;
+            spill_lease& operator=(const spill_lease&) = delete;
+        };
+#endif
+
         template <class S>
         struct sink_ref {
             S* base{};
@@ -135,10 +449,34 @@ export namespace out {
 
         template <class S, bool Enabled>
         constexpr S* base_ptr(const ansi::ansi_sink_ref<S, Enabled>& s) noexcept { return s.base; }
+
+        // Sinks a logger reaches through a pointer; the target outlives the logger.
+        template <class S>
+        inline constexpr bool is_sink_handle_v = false;
+
+        template <class S>
+        inline constexpr bool is_sink_handle_v<sink_ref<S>> = true;
+
+        template <class S, bool Enabled>
+        inline constexpr bool is_sink_handle_v<ansi::ansi_sink_ref<S, Enabled>> = true;
+
+        template <class S>
+        result<std::size_t> flush_thunk(void* c) noexcept { return static_cast<S*>(c)->flush(); }
+
+        // Marks the policy's record as open for the duration of one emit.
+        struct open_record {
+            flush_policy* p;
+            explicit open_record(flush_policy* fp) noexcept : p(fp) { if (p) p->in_record = true; }
+            ~open_record() { if (p) p->in_record = false; }
+            open_record(const open_record&) = delete;
+            open_record& operator=(const open_record&) = delete;
+        };
     }
 
     // BypassLevelGate is used by raw formatting paths (non-logging output).
-    template <level L, class Domain, class Sink, bool BypassLevelGate = false>
+    // Json selects the JSON Lines record format at compile time (see json()), so
+    // text-only builds never instantiate the JSON writer.
+    template <level L, class Domain, class Sink, bool BypassLevelGate = false, bool Json = false>
     struct logger {
         Sink sink;
         std::array<style_cmd, 8> styles{};
@@ -148,27 +486,33 @@ export namespace out {
         bool with_level = true;
         bool with_domain = false;
         bool flush_enabled = true;
+        flush_policy* flush_pol = nullptr;  // null: flush after every line
         newline nl = newline::crlf;
 
         explicit constexpr logger(Sink s) noexcept : sink(std::move(s)) {}
 
         template <class NewSink>
         constexpr auto with_sink(NewSink ns) const noexcept {
-            logger<L, Domain, NewSink, BypassLevelGate> out{std::move(ns)};
+            logger<L, Domain, NewSink, BypassLevelGate, Json> out{std::move(ns)};
             copy_opts_to(out);
             return out;
         }
 
         template <bool Enabled = true>
         constexpr auto ansi() const noexcept {
-            auto* base = detail::base_ptr(sink);
-            using base_t = std::remove_reference_t<decltype(*base)>;
-            return with_sink(ansi::ansi_sink_ref<base_t, Enabled>{base});
+            if constexpr (std::is_same_v<Sink, sink_view>) {
+                // Stay erased: ANSI is a flag on the view, not a new sink type.
+                return with_sink(sink.template ansi<Enabled>());
+            } else {
+                auto* base = detail::base_ptr(sink);
+                using base_t = std::remove_reference_t<decltype(*base)>;
+                return with_sink(ansi::ansi_sink_ref<base_t, Enabled>{base});
+            }
         }
 
         template <class NewDomain>
         constexpr auto domain() const noexcept {
-            logger<L, NewDomain, Sink, BypassLevelGate> out{sink};
+            logger<L, NewDomain, Sink, BypassLevelGate, Json> out{sink};
             copy_opts_to(out);
             return out;
         }
@@ -182,6 +526,30 @@ export namespace out {
         constexpr logger& set_newline(newline n) noexcept { nl = n; return *this; }
         constexpr logger& flush(bool on = true) noexcept { flush_enabled = on; return *this; }
         constexpr logger& no_flush() noexcept { flush_enabled = false; return *this; }
+        // Also binds the sink to p, so p.request() can flush it directly. Sinks
+        // held by value live inside this logger and are not bound.
+        constexpr logger& flush_with(flush_policy& p) noexcept {
+            flush_pol = &p;
+            if constexpr (std::is_same_v<Sink, sink_view>) {
+                p.target = sink.ctx;
+                p.flush_fn = sink.flush_fn;
+            } else if constexpr (detail::is_sink_handle_v<Sink>) {
+                using base_t = std::remove_pointer_t<decltype(detail::base_ptr(sink))>;
+                if constexpr (Flushable<base_t>) {
+                    p.target = detail::base_ptr(sink);
+                    p.flush_fn = &detail::flush_thunk<base_t>;
+                }
+            }
+            return *this;
+        }
+        // JSON Lines: {"ts":..,"level":"..","domain":"..","msg":"..","arg0":..} per record.
+        // Prefix/style/newline options do not apply; style tokens are left out.
+        template <bool Enabled = true>
+        constexpr auto json() const noexcept {
+            logger<L, Domain, Sink, BypassLevelGate, Enabled> out{sink};
+            copy_opts_to(out);
+            return out;
+        }
 
         template <class... Tokens>
         constexpr logger& style(Tokens&&... tokens) noexcept {
@@ -211,6 +579,39 @@ export namespace out {
             return detail::finalize(r);
         }
 
+        // Flushes the sink immediately and restarts the flush policy's budgets.
+        inline result<std::size_t> try_flush_now() noexcept {
+            auto* base = detail::base_ptr(sink);
+            using base_t = std::remove_reference_t<decltype(*base)>;
+            if (flush_pol) flush_pol->mark_flushed();
+            if constexpr (Flushable<base_t>) {
+                return base->flush();
+            } else {
+                return ok<std::size_t>(0u);
+            }
+        }
+
+        // Flushes if the policy has a pending request or its every_ms deadline has
+        // passed since buffered records; a no-op without a policy.
+        inline result<std::size_t> try_poll() noexcept {
+            if (!flush_pol || !flush_pol->on_poll()) return ok<std::size_t>(0u);
+            auto* base = detail::base_ptr(sink);
+            using base_t = std::remove_reference_t<decltype(*base)>;
+            if constexpr (Flushable<base_t>) {
+                return base->flush();
+            } else {
+                return ok<std::size_t>(0u);
+            }
+        }
+
+        OUT_LOGGER_NODISCARD inline detail::public_return_t<std::size_t> flush_now() noexcept {
+            return detail::finalize(try_flush_now());
+        }
+
+        OUT_LOGGER_NODISCARD inline detail::public_return_t<std::size_t> poll() noexcept {
+            return detail::finalize(try_poll());
+        }
+
     private:
         template <class Other>
         constexpr void copy_opts_to(Other& out) const noexcept {
@@ -221,6 +622,7 @@ export namespace out {
             out.with_level = with_level;
             out.with_domain = with_domain;
             out.flush_enabled = flush_enabled;
+            out.flush_pol = flush_pol;
             out.nl = nl;
         }
 
@@ -314,88 +716,212 @@ export namespace out {
             return ok(total);
         }
 
+        // Flushes the record, closes it on record sinks and applies the flush policy.
+        template <class W, class B>
+        inline result<std::size_t> finish_record(W& bw, B* base, detail::tally total, bool line_end) noexcept {
+            auto rwo = bw.flush();
+            if (!rwo) return std::unexpected(rwo.error());
+            total.add(*rwo);
+
+            if constexpr (RecordSink<B>) {
+                auto rre = base->end_record();
+                if (!rre) return std::unexpected(rre.error());
+                total.add(*rre);
+            }
+
+            if (line_end) {
+                if (flush_enabled && (!flush_pol || flush_pol->on_record(L, total.get()))) {
+                    if constexpr (Flushable<B>) {
+                        auto rf = base->flush();
+                        if (!rf) return std::unexpected(rf.error());
+                        total.add(*rf);
+                    }
+                }
+            }
+
+            return ok(total.get());
+        }
+
+        static constexpr std::string_view level_name() noexcept {
+            if constexpr (L == level::error) return "error";
+            else if constexpr (L == level::warn) return "warn";
+            else if constexpr (L == level::info) return "info";
+            else if constexpr (L == level::debug) return "debug";
+            else if constexpr (L == level::trace) return "trace";
+            else return "";
+        }
+
+        template <class W, class T>
+        static result<std::size_t> write_json_value(W& bw, const T& v) noexcept {
+            using U = std::remove_cvref_t<T>;
+            if constexpr (std::is_same_v<U, bool>) {
+                return bw.append(v ? "true" : "false");
+            } else if constexpr (std::is_integral_v<U> && !std::is_same_v<U, char> &&
+                                 !std::is_same_v<U, char8_t> && !std::is_same_v<U, wchar_t>) {
+                return vprint<"{}", W, false>(bw, v);
+#if defined(OUT_ENABLE_FLOAT)
+            } else if constexpr (std::is_floating_point_v<U>) {
+                // NaN/Inf are not JSON numbers.
+                if (v != v || v - v != 0) return bw.append("null");
+                return vprint<"{:f}", W, false>(bw, v);
+#endif
+            } else {
+                detail::tally total;
+                auto rq = bw.append("\"");
+                if (!rq) return std::unexpected(rq.error());
+                total.add(*rq);
+                detail::json_escaper<W> esc{bw};
+                auto rv = vprint<"{}">(esc, v);
+                if (!rv) return std::unexpected(rv.error());
+                total.add(*rv);
+                auto re = bw.append("\"");
+                if (!re) return std::unexpected(re.error());
+                total.add(*re);
+                return ok(total.get());
+            }
+        }
+
+        template <fixed_string Fmt, class W, class... Vals>
+        inline result<std::size_t> write_json(W& bw, const Vals&... vals) noexcept {
+            detail::tally total;
+            auto rh = vprint<"{{\"ts\":{},\"level\":\"{}\"", W, false>(bw, port::now_ms(), level_name());
+            if (!rh) return std::unexpected(rh.error());
+            total.add(*rh);
+
+            detail::json_escaper<W> esc{bw};
+            if constexpr (domain_name<Domain>.size() != 0) {
+                auto rd = bw.append(",\"domain\":\"");
+                if (!rd) return std::unexpected(rd.error());
+                total.add(*rd);
+                auto rn = out::write(esc, domain_name<Domain>);
+                if (!rn) return std::unexpected(rn.error());
+                total.add(*rn);
+                auto rq = bw.append("\"");
+                if (!rq) return std::unexpected(rq.error());
+                total.add(*rq);
+            }
+
+            auto rm = bw.append(",\"msg\":\"");
+            if (!rm) return std::unexpected(rm.error());
+            total.add(*rm);
+            auto r = vprint<Fmt>(esc, vals...);
+            if (!r) return std::unexpected(r.error());
+            total.add(*r);
+            auto rq = bw.append("\"");
+            if (!rq) return std::unexpected(rq.error());
+            total.add(*rq);
+
+            result<std::size_t> ra = ok<std::size_t>(0u);
+            [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+                (void)(((ra = write_json_field<Is>(bw, vals, total)).has_value() && ...));
+            }(std::index_sequence_for<Vals...>{});
+            if (!ra) return std::unexpected(ra.error());
+
+            auto rc = bw.append("}\n");
+            if (!rc) return std::unexpected(rc.error());
+            total.add(*rc);
+            return ok(total.get());
+        }
+
+        // Adds the bytes written to total, so the fold above only chains errors.
+        template <std::size_t I, class W, class T>
+        static result<std::size_t> write_json_field(W& bw, const T& v, detail::tally& total) noexcept {
+            if constexpr (detail::is_style_token_v<std::remove_cvref_t<T>>) {
+                return ok<std::size_t>(0u);
+            } else {
+                auto rk = vprint<",\"arg{}\":", W, false>(bw, I);
+                if (!rk) return std::unexpected(rk.error());
+                auto rv = write_json_value(bw, v);
+                if (!rv) return std::unexpected(rv.error());
+                total.add(*rk);
+                total.add(*rv);
+                return ok<std::size_t>(0u);
+            }
+        }
+
         template <bool WithNewline, fixed_string Fmt, class... Args>
         inline result<std::size_t> try_emit_impl(Args&&... args) noexcept {
             if constexpr (domain_enabled<Domain> &&
                           (BypassLevelGate || (L != level::off && build_level >= L))) {
-                std::size_t total = 0;
+                detail::tally total;
+                auto* base = detail::base_ptr(sink);
+                using base_t = std::remove_reference_t<decltype(*base)>;
 
-                detail::buffered_writer<decltype(sink), OUT_LOGGER_WRITE_BUFFER_SIZE> bw{sink};
-
-                if (with_timestamp) {
-                    auto rts = vprint<"[{}] ", decltype(bw), false>(bw, port::now_ms());
-                    if (!rts) return std::unexpected(rts.error());
-                    total += *rts;
+                detail::open_record open{flush_pol};
+                if constexpr (RecordMetaSink<base_t>) {
+                    base->begin_record(L, domain_name<Domain>);
                 }
 
-                if (with_level) {
-                    char buf[4] = {'[', level_tag(), ']', ' '};
-                    auto rp = bw.append(std::string_view{buf, sizeof(buf)});
-                    if (!rp) return std::unexpected(rp.error());
-                    total += *rp;
-                }
+                detail::buffered_writer<decltype(sink), OUT_LOGGER_WRITE_BUFFER_SIZE,
+                                        (OUT_LOGGER_SPILL_SIZE > 0)> bw{sink};
+#if OUT_LOGGER_SPILL_SIZE > 0
+                detail::spill_lease lease;
+                bw.spill = lease.arena;
+#endif
 
-                if (with_domain) {
-                    if constexpr (domain_name<Domain>.size() != 0) {
-                        auto r1 = bw.append("[");
-                        if (!r1) return std::unexpected(r1.error());
-                        total += *r1;
-                        auto r2 = bw.append(domain_name<Domain>);
-                        if (!r2) return std::unexpected(r2.error());
-                        total += *r2;
-                        auto r3 = bw.append("] ");
-                        if (!r3) return std::unexpected(r3.error());
-                        total += *r3;
+                if constexpr (Json) {
+                    auto rj = write_json<Fmt>(bw, eval(std::forward<Args>(args))...);
+                    if (!rj) return std::unexpected(rj.error());
+                    total.add(*rj);
+                    return finish_record(bw, base, total, true);
+                } else {
+                    if (with_timestamp) {
+                        auto rts = vprint<"[{}] ", decltype(bw), false>(bw, port::now_ms());
+                        if (!rts) return std::unexpected(rts.error());
+                        total.add(*rts);
                     }
-                }
 
-                bool need_reset = auto_reset_enabled && style_count > 0;
-                constexpr bool sink_is_ansi = ansi::AnsiSink<decltype(bw)>;
-                auto rs = write_styles_combined(bw, sink_is_ansi && need_reset);
-                if (!rs) return std::unexpected(rs.error());
-                total += *rs;
-                if constexpr (sink_is_ansi) {
-                    if (need_reset) need_reset = false;
-                }
+                    if (with_level) {
+                        char buf[4] = {'[', level_tag(), ']', ' '};
+                        auto rp = bw.append(std::string_view{buf, sizeof(buf)});
+                        if (!rp) return std::unexpected(rp.error());
+                        total.add(*rp);
+                    }
 
-                auto r = vprint<Fmt, decltype(bw), false>(bw, eval(std::forward<Args>(args))...);
-                if (!r) return std::unexpected(r.error());
-                total += *r;
+                    if (with_domain) {
+                        if constexpr (domain_name<Domain>.size() != 0) {
+                            auto r1 = bw.append("[");
+                            if (!r1) return std::unexpected(r1.error());
+                            total.add(*r1);
+                            auto r2 = bw.append(domain_name<Domain>);
+                            if (!r2) return std::unexpected(r2.error());
+                            total.add(*r2);
+                            auto r3 = bw.append("] ");
+                            if (!r3) return std::unexpected(r3.error());
+                            total.add(*r3);
+                        }
+                    }
 
-                if (need_reset) {
-                    auto rr = write_style(bw, make_style(reset_t{}));
-                    if (!rr) return std::unexpected(rr.error());
-                    total += *rr;
-                }
+                    bool need_reset = auto_reset_enabled && style_count > 0;
+                    constexpr bool sink_is_ansi = ansi::AnsiSink<decltype(bw)>;
+                    auto rs = write_styles_combined(bw, sink_is_ansi && need_reset);
+                    if (!rs) return std::unexpected(rs.error());
+                    total.add(*rs);
+                    if constexpr (sink_is_ansi) {
+                        if (need_reset) need_reset = false;
+                    }
+
+                    auto r = vprint<Fmt, decltype(bw), false>(bw, eval(std::forward<Args>(args))...);
+                    if (!r) return std::unexpected(r.error());
+                    total.add(*r);
 
-                if constexpr (WithNewline) {
-                    if (nl != newline::none) {
-                        std::string_view nl_sv = (nl == newline::crlf) ? "\r\n" : "\n";
-                        auto rn = bw.append(nl_sv);
-                        if (!rn) return std::unexpected(rn.error());
-                        total += *rn;
+                    if (need_reset) {
+                        auto rr = write_style(bw, make_style(reset_t{}));
+                        if (!rr) return std::unexpected(rr.error());
+                        total.add(*rr);
                     }
-                }
 
-                auto rwo = bw.flush();
-                if (!rwo) return std::unexpected(rwo.error());
-                total += *rwo;
-
-                if constexpr (WithNewline) {
-                    if (nl != newline::none) {
-                        if (flush_enabled) {
-                            auto* base = detail::base_ptr(sink);
-                            using base_t = std::remove_reference_t<decltype(*base)>;
-                            if constexpr (Flushable<base_t>) {
-                                auto rf = base->flush();
-                                if (!rf) return std::unexpected(rf.error());
-                                total += *rf;
-                            }
+                    if constexpr (WithNewline) {
+                        if (nl != newline::none) {
+                            std::string_view nl_sv = (nl == newline::crlf) ? "\r\n" : "\n";
+                            auto rn = bw.append(nl_sv);
+                            if (!rn) return std::unexpected(rn.error());
+                            total.add(*rn);
                         }
                     }
-                }
 
-                return ok(total);
+                    return finish_record(bw, base, total, WithNewline && nl != newline::none);
+                }
             } else {
                 return ok(0u);
             }
@@ -406,3 +932,4 @@ export namespace out {
 
 #undef OUT_LOGGER_NODISCARD
 #undef OUT_LOGGER_WRITE_BUFFER_SIZE
+#undef OUT_LOGGER_SPILL_SIZE
@@ -0,0 +1,198 @@
+module;
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <string_view>
+
+export module out.otlp;
+// Dependency contract (DO NOT VIOLATE)
+// Allowed out.* imports: out.core, out.sink, out.domain
+// Forbidden out.* imports: out.format, out.ansi, out.logger, out.api, out.port, out.print
+// Rationale: wire encoders for structured log collectors. Must stay formatting-agnostic.
+// If you need functionality from a higher layer, add an extension point in this layer instead.
+
+import out.core;
+import out.domain;
+import out.sink;
+
+export namespace out::otlp {
+
+    // OpenTelemetry SeverityNumber for a logger level (0 = unspecified).
+    constexpr std::uint8_t severity_number(level l) noexcept {
+        switch (l) {
+        case level::error: return 17;
+        case level::warn: return 13;
+        case level::info: return 9;
+        case level::debug: return 5;
+        case level::trace: return 1;
+        default: return 0;
+        }
+    }
+
+    constexpr std::string_view severity_text(level l) noexcept {
+        switch (l) {
+        case level::error: return "ERROR";
+        case level::warn: return "WARN";
+        case level::info: return "INFO";
+        case level::debug: return "DEBUG";
+        case level::trace: return "TRACE";
+        default: return {};
+        }
+    }
+
+    namespace detail {
+        // Field tags from opentelemetry/proto/logs/v1/logs.proto (LogRecord),
+        // common/v1/common.proto (AnyValue, KeyValue).
+        inline constexpr unsigned char tag_time_unix_nano = (1 << 3) | 1;   // fixed64
+        inline constexpr unsigned char tag_severity_number = (2 << 3) | 0;  // varint
+        inline constexpr unsigned char tag_severity_text = (3 << 3) | 2;
+        inline constexpr unsigned char tag_body = (5 << 3) | 2;             // AnyValue
+        inline constexpr unsigned char tag_attributes = (6 << 3) | 2;       // KeyValue
+        inline constexpr unsigned char tag_string_value = (1 << 3) | 2;     // AnyValue.string_value
+        inline constexpr unsigned char tag_key = (1 << 3) | 2;              // KeyValue.key
+        inline constexpr unsigned char tag_value = (2 << 3) | 2;            // KeyValue.value
+
+        constexpr std::size_t varint_size(std::uint64_t v) noexcept {
+            std::size_t n = 1;
+            while (v >= 0x80) {
+                v >>= 7;
+                ++n;
+            }
+            return n;
+        }
+
+        constexpr unsigned char* put_varint(unsigned char* p, std::uint64_t v) noexcept {
+            while (v >= 0x80) {
+                *p++ = static_cast<unsigned char>(v | 0x80);
+                v >>= 7;
+            }
+            *p++ = static_cast<unsigned char>(v);
+            return p;
+        }
+
+        inline unsigned char* put_string(unsigned char* p, unsigned char tag, std::string_view s) noexcept {
+            *p++ = tag;
+            p = put_varint(p, s.size());
+            std::memcpy(p, s.data(), s.size());
+            return p + s.size();
+        }
+
+        // Encoded size of a length-delimited field with an n-byte payload.
+        constexpr std::size_t field_size(std::size_t n) noexcept { return 1 + varint_size(n) + n; }
+    }
+
+    // Encodes every logger record as an OTLP LogRecord protobuf message and hands
+    // it to Base as one varint-length-delimited write (the framing of protobuf's
+    // writeDelimitedTo), followed by Base::end_record() when available. Fields:
+    //   time_unix_nano   from now_unix_nano() (omitted when no clock is given)
+    //   severity_number/severity_text from the record level
+    //   body             the formatted payload as AnyValue.string_value
+    //   attributes       {"domain": domain name} for named domains
+    // The logger prefixes ("[I] ", timestamp) end up in the body; turn them off
+    // with level_prefix(false). Trailing CR/LF is dropped; payloads longer than
+    // MaxBody are truncated. No heap: the record is staged in a fixed buffer and
+    // the protobuf header is encoded in front of it once the body size is known.
+    // A collector-side shim wraps the records into ExportLogsServiceRequest.
+    template <Sink Base, std::size_t MaxBody = 1024>
+    struct log_sink {
+        using clock_fn = std::uint64_t (*)() noexcept;
+
+        Base& base;
+
+        explicit log_sink(Base& b, clock_fn now_unix_nano = nullptr) noexcept
+            : base(b), clock(now_unix_nano) {}
+
+        void begin_record(level l, std::string_view domain) noexcept {
+            lvl = l;
+            dom = domain.substr(0, domain_max);
+            len = 0;
+            open = true;
+        }
+
+        result<std::size_t> write(bytes b) noexcept {
+            if (!open) begin_record(level::info, {});
+            const std::size_t room = MaxBody - len;
+            const std::size_t n = (b.size() < room) ? b.size() : room;
+            std::memcpy(buf.data() + header_max + len, b.data(), n);
+            len += n;
+            return ok(b.size());
+        }
+
+        result<std::size_t> end_record() noexcept {
+            if (!open) return ok<std::size_t>(0u);
+            open = false;
+            unsigned char* const body = buf.data() + header_max;
+            while (len != 0 && (body[len - 1] == '\n' || body[len - 1] == '\r')) --len;
+
+            // Attributes go after the body; field order does not matter in protobuf.
+            unsigned char* p = body + len;
+            if (!dom.empty()) {
+                constexpr std::string_view key = "domain";
+                const std::size_t any = detail::field_size(dom.size());
+                const std::size_t kv = detail::field_size(key.size()) + detail::field_size(any);
+                *p++ = detail::tag_attributes;
+                p = detail::put_varint(p, kv);
+                p = detail::put_string(p, detail::tag_key, key);
+                *p++ = detail::tag_value;
+                p = detail::put_varint(p, any);
+                p = detail::put_string(p, detail::tag_string_value, dom);
+            }
+            const std::size_t tail = static_cast<std::size_t>(p - (body + len));
+
+            // Header fields in front of the body, built forward in a scratch array.
+            std::array<unsigned char, header_max> h{};
+            unsigned char* q = h.data();
+            if (clock) {
+                const std::uint64_t t = clock();
+                *q++ = detail::tag_time_unix_nano;
+                for (int i = 0; i < 8; ++i) *q++ = static_cast<unsigned char>(t >> (8 * i));
+            }
+            if (const auto sev = severity_number(lvl)) {
+                *q++ = detail::tag_severity_number;
+                q = detail::put_varint(q, sev);
+                q = detail::put_string(q, detail::tag_severity_text, severity_text(lvl));
+            }
+            const std::size_t any = detail::field_size(len);
+            *q++ = detail::tag_body;
+            q = detail::put_varint(q, any);
+            *q++ = detail::tag_string_value;
+            q = detail::put_varint(q, len);
+            const std::size_t fields = static_cast<std::size_t>(q - h.data());
+            const std::size_t msg = fields + len + tail;
+
+            unsigned char* start = body - fields - detail::varint_size(msg);
+            detail::put_varint(start, msg);
+            std::memcpy(body - fields, h.data(), fields);
+
+            auto r = base.write(bytes{reinterpret_cast<const std::byte*>(start),
+                                      static_cast<std::size_t>(p - start)});
+            if (!r) return std::unexpected(r.error());
+            if constexpr (RecordSink<Base>) {
+                return base.end_record();
+            } else {
+                return ok<std::size_t>(0u);
+            }
+        }
+
+        template <class B = Base>
+          requires Flushable<B>
+        result<std::size_t> flush() noexcept { return base.flush(); }
+
+      private:
+        // Worst case: length varint, time, severity, body tags and lengths.
+        static constexpr std::size_t header_max = 10 + 9 + 2 + 7 + 1 + 10 + 1 + 10;
+        // "domain" attribute; longer domain names are cut to domain_max bytes.
+        static constexpr std::size_t domain_max = 64;
+        static constexpr std::size_t attr_max = 16 + domain_max;
+
+        std::array<unsigned char, header_max + MaxBody + attr_max> buf{};
+        clock_fn clock;
+        std::string_view dom{};
+        std::size_t len = 0;
+        level lvl = level::info;
+        bool open = false;
+    };
+
+}
@@ -0,0 +1,973 @@
+module;
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <string_view>
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+export module out.posix;
+// Dependency contract (DO NOT VIOLATE)
+// Allowed out.* imports: out.core, out.sink, out.domain
+// Forbidden out.* imports: out.format, out.ansi, out.logger, out.api, out.port, out.print
+// Rationale: POSIX-only sinks (sockets/files/shared memory). Must stay formatting-agnostic.
+// If you need functionality from a higher layer, add an extension point in this layer instead.
+
+import out.core;
+import out.domain;
+import out.sink;
+
+// Everything below needs a POSIX host; on bare-metal targets this module is empty.
+#if defined(__unix__) || defined(__APPLE__)
+export namespace out::posix {
+
+    // Wire format used by unix_log_sink.
+    // rfc5424:  "<PRI>1 - - IDENT PID MSGID - MSG" (MSGID = domain name or "-";
+    //           APP-NAME/MSGID are cut to 48/32 bytes, bytes outside '!'..'~' become '_').
+    // journald: native protocol, PRIORITY/SYSLOG_IDENTIFIER/OUT_DOMAIN/MESSAGE fields.
+    enum class log_protocol : std::uint8_t { rfc5424, journald };
+
+    namespace detail {
+        constexpr std::uint8_t syslog_severity(level l) noexcept {
+            switch (l) {
+            case level::error: return 3; // err
+            case level::warn: return 4;  // warning
+            case level::info: return 6;  // info
+            default: return 7;           // debug (debug/trace)
+            }
+        }
+    }
+
+    // Unix datagram sink for local log daemons (/dev/log, /run/systemd/journal/socket).
+    // One logger record == one datagram: level/domain arrive via begin_record(),
+    // the record is closed by end_record(). Closed records are staged in Batch slots
+    // and sent with a single sendmmsg() on flush() or when all slots are used.
+    // Loggers flush after every line by default, which sends one datagram per
+    // record; use no_flush() or flush_with(policy) on the logger to let records
+    // batch, and call flush() when done.
+    // Records longer than MaxRecord are truncated; header fields (ident, domain)
+    // are shortened so the header always fits. A failed send drops the batch.
+    // ident is not copied and must outlive the sink.
+    template <std::size_t MaxRecord = 1024, std::size_t Batch = 8>
+    struct unix_log_sink {
+        static_assert(MaxRecord >= 128, "MaxRecord too small for the record header");
+        static_assert(Batch != 0);
+
+        explicit unix_log_sink(const char* path,
+                               log_protocol proto = log_protocol::rfc5424,
+                               std::string_view ident = "out",
+                               std::uint8_t facility = 1) noexcept
+            : proto_(proto), ident_(ident), facility_(facility), pid_(static_cast<std::uint32_t>(::getpid())) {
+            fd_ = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+            if (fd_ < 0) return;
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            const std::size_t n = std::strlen(path);
+            if (n >= sizeof(addr.sun_path) ||
+                (std::memcpy(addr.sun_path, path, n + 1),
+                 ::connect(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)) {
+                ::close(fd_);
+                fd_ = -1;
+            }
+        }
+
+        unix_log_sink(const unix_log_sink&) = delete;
+        unix_log_sink& operator=(const unix_log_sink&) = delete;
+
+        // Destructor flushes best-effort; errors are intentionally ignored.
+        ~unix_log_sink() {
+            (void)flush();
+            if (fd_ >= 0) ::close(fd_);
+        }
+
+        bool is_open() const noexcept { return fd_ >= 0; }
+
+        void begin_record(level l, std::string_view domain) noexcept {
+            len_ = 0;
+            open_ = true;
+            const std::uint8_t sev = detail::syslog_severity(l);
+            if (proto_ == log_protocol::rfc5424) {
+                put("<");
+                put_uint(static_cast<std::uint32_t>(facility_) * 8u + sev);
+                put(">1 - - ");
+                put_token(ident_, 48);
+                put(" ");
+                put_uint(pid_);
+                put(" ");
+                put_token(domain, 32);
+                put(" - ");
+            } else {
+                put("PRIORITY=");
+                put_uint(sev);
+                put("\nSYSLOG_FACILITY=");
+                put_uint(facility_);
+                put("\n");
+                put_field("SYSLOG_IDENTIFIER=", ident_);
+                if (!domain.empty()) put_field("OUT_DOMAIN=", domain);
+                // Binary field form: the payload may contain newlines; the
+                // little-endian length is patched in end_record().
+                // put_field() leaves room for this tail ("MESSAGE\n", length, '\n').
+                put("MESSAGE\n");
+                len_ += 8;
+            }
+            body_ = len_;
+        }
+
+        result<std::size_t> write(bytes b) noexcept {
+            if (fd_ < 0) return std::unexpected(errc::io_error);
+            if (!open_) begin_record(level::info, {});
+            // journald needs one trailing '\n' after the binary field.
+            const std::size_t cap = MaxRecord - (proto_ == log_protocol::journald ? 1u : 0u);
+            const std::size_t room = (len_ < cap) ? cap - len_ : 0;
+            const std::size_t n = (b.size() < room) ? b.size() : room;
+            std::memcpy(slots_[count_].data() + len_, b.data(), n);
+            len_ += n;
+            return ok(b.size());
+        }
+
+        result<std::size_t> end_record() noexcept {
+            if (!open_) return ok<std::size_t>(0u);
+            open_ = false;
+            auto* p = slots_[count_].data();
+            // Daemons add their own line structure; drop the logger newline.
+            while (len_ > body_ && (p[len_ - 1] == '\n' || p[len_ - 1] == '\r')) --len_;
+            if (proto_ == log_protocol::journald) {
+                std::uint64_t n = len_ - body_;
+                for (std::size_t i = 0; i < 8; ++i) {
+                    p[body_ - 8 + i] = static_cast<char>(n & 0xFFu);
+                    n >>= 8;
+                }
+                if (len_ < MaxRecord) p[len_++] = '\n';
+            }
+            lens_[count_++] = len_;
+            len_ = 0;
+            if (count_ == Batch) return flush();
+            return ok<std::size_t>(0u);
+        }
+
+        // Sends all closed records; an open (unterminated) record stays staged.
+        result<std::size_t> flush() noexcept {
+            if (count_ == 0) return ok<std::size_t>(0u);
+            if (fd_ < 0) {
+                drop_closed();
+                return std::unexpected(errc::io_error);
+            }
+            std::size_t sent = 0;
+            std::size_t i = 0;
+            while (i < count_) {
+#if defined(__linux__)
+                std::array<iovec, Batch> iov{};
+                std::array<mmsghdr, Batch> msgs{};
+                const std::size_t n = count_ - i;
+                for (std::size_t k = 0; k < n; ++k) {
+                    iov[k].iov_base = slots_[i + k].data();
+                    iov[k].iov_len = lens_[i + k];
+                    msgs[k].msg_hdr.msg_iov = &iov[k];
+                    msgs[k].msg_hdr.msg_iovlen = 1;
+                }
+                const int r = ::sendmmsg(fd_, msgs.data(), static_cast<unsigned>(n), 0);
+                if (r < 0) {
+                    if (errno == EINTR) continue;
+                    drop_closed();
+                    return std::unexpected(errc::io_error);
+                }
+                for (int k = 0; k < r; ++k) sent += msgs[static_cast<std::size_t>(k)].msg_len;
+                i += static_cast<std::size_t>(r);
+#else
+                const auto r = ::send(fd_, slots_[i].data(), lens_[i], 0);
+                if (r < 0) {
+                    if (errno == EINTR) continue;
+                    drop_closed();
+                    return std::unexpected(errc::io_error);
+                }
+                sent += static_cast<std::size_t>(r);
+                ++i;
+#endif
+            }
+            drop_closed();
+            return ok(sent);
+        }
+
+      private:
+        void put(std::string_view sv) noexcept {
+            const std::size_t room = MaxRecord - len_;
+            const std::size_t n = (sv.size() < room) ? sv.size() : room;
+            std::memcpy(slots_[count_].data() + len_, sv.data(), n);
+            len_ += n;
+        }
+
+        // RFC 5424 header field: at most max printable US-ASCII bytes without
+        // spaces; other bytes become '_', an empty value becomes the nil value "-".
+        void put_token(std::string_view sv, std::size_t max) noexcept {
+            if (sv.empty()) {
+                put("-");
+                return;
+            }
+            char tmp[48];
+            if (max > sizeof(tmp)) max = sizeof(tmp);
+            if (sv.size() > max) sv = sv.substr(0, max);
+            for (std::size_t i = 0; i < sv.size(); ++i) {
+                const auto c = static_cast<unsigned char>(sv[i]);
+                tmp[i] = (c >= 33 && c <= 126) ? sv[i] : '_';
+            }
+            put(std::string_view{tmp, sv.size()});
+        }
+
+        // journald "NAME=value\n" with the value shortened so the field and the
+        // MESSAGE tail (8 + 8 + 1 bytes) still fit; a field that cannot fit is skipped.
+        void put_field(std::string_view name, std::string_view value) noexcept {
+            constexpr std::size_t tail = 17;
+            const std::size_t fixed = len_ + name.size() + 1 + tail;
+            if (fixed > MaxRecord) return;
+            put(name);
+            put(value.substr(0, MaxRecord - fixed));
+            put("\n");
+        }
+
+        void put_uint(std::uint32_t v) noexcept {
+            char tmp[10];
+            std::size_t n = 0;
+            do {
+                tmp[sizeof(tmp) - ++n] = static_cast<char>('0' + v % 10u);
+                v /= 10u;
+            } while (v != 0);
+            put(std::string_view{tmp + sizeof(tmp) - n, n});
+        }
+
+        // Keeps a partially written record (if any) as the first slot.
+        void drop_closed() noexcept {
+            if (open_ && count_ != 0) {
+                std::memcpy(slots_[0].data(), slots_[count_].data(), len_);
+            }
+            count_ = 0;
+        }
+
+        int fd_ = -1;
+        log_protocol proto_;
+        std::string_view ident_;
+        std::uint8_t facility_;
+        std::uint32_t pid_;
+        std::array<std::array<char, MaxRecord>, Batch> slots_{};
+        std::array<std::size_t, Batch> lens_{};
+        std::size_t count_ = 0;  // closed records waiting for flush()
+        std::size_t len_ = 0;    // bytes in the open record (slot count_)
+        std::size_t body_ = 0;   // payload offset in the open record
+        bool open_ = false;
+    };
+
+
+    // ------------------------------------------------------------------
+    // Persistent flight recorder: a ring in a MAP_SHARED file.
+    // Stores land in the page cache, so the history survives a crash or kill -9
+    // of the writer without any msync() on the hot path; read it back with
+    // dump_mmap_ring() (see examples/linux/out-ringdump.cpp).
+    //
+    // File layout (version 2): mmap_ring_header, then `capacity` data bytes.
+    // Data is a sequence of frames at absolute positions [tail, wpos):
+    //   u32 len_flags  payload length; bit31 = payload starts a record
+    //   u32 check      ~(len_flags ^ folded position): rejects stale/torn frames
+    //   u32 crc        CRC-32 of the payload
+    //   payload
+    // Frames wrap around the end of the data area. After a power loss the header
+    // page may reach the disk without the data pages, so neither side trusts a
+    // frame before its check word and payload CRC match.
+
+    struct mmap_ring_header {
+        char magic[8];              // "OUTRING\0"
+        std::uint32_t version;      // mmap_ring_version
+        std::uint32_t header_size;  // sizeof(mmap_ring_header)
+        std::uint64_t capacity;     // data bytes, power of two
+        std::uint32_t checksum;     // FNV-1a over the fields above
+        std::uint32_t reserved;
+        std::uint64_t tail;         // oldest intact frame (absolute)
+        std::uint64_t wpos;         // end of the newest complete frame (absolute)
+        std::uint8_t pad[16];
+    };
+    static_assert(sizeof(mmap_ring_header) == 64);
+
+    inline constexpr std::uint32_t mmap_ring_version = 2;
+
+    namespace detail {
+        inline constexpr char ring_magic[8] = {'O', 'U', 'T', 'R', 'I', 'N', 'G', '\0'};
+        inline constexpr std::uint32_t frame_start = 1u << 31;
+        inline constexpr std::size_t frame_header = 12;
+
+        inline std::uint32_t ring_header_checksum(const mmap_ring_header& h) noexcept {
+            auto p = reinterpret_cast<const unsigned char*>(&h);
+            std::uint32_t x = 2166136261u;
+            for (std::size_t i = 0; i < offsetof(mmap_ring_header, checksum); ++i) {
+                x = (x ^ p[i]) * 16777619u;
+            }
+            return x;
+        }
+
+        constexpr std::uint32_t frame_check(std::uint32_t len_flags, std::uint64_t pos) noexcept {
+            return ~(len_flags ^ static_cast<std::uint32_t>(pos ^ (pos >> 32)));
+        }
+
+        inline void ring_put(char* data, std::uint64_t cap, std::uint64_t pos,
+                             const void* src, std::size_t n) noexcept {
+            const std::size_t at = static_cast<std::size_t>(pos & (cap - 1));
+            const std::size_t n1 = (n < cap - at) ? n : static_cast<std::size_t>(cap - at);
+            std::memcpy(data + at, src, n1);
+            std::memcpy(data, static_cast<const char*>(src) + n1, n - n1);
+        }
+
+        inline void ring_get(const char* data, std::uint64_t cap, std::uint64_t pos,
+                             void* dst, std::size_t n) noexcept {
+            const std::size_t at = static_cast<std::size_t>(pos & (cap - 1));
+            const std::size_t n1 = (n < cap - at) ? n : static_cast<std::size_t>(cap - at);
+            std::memcpy(dst, data + at, n1);
+            std::memcpy(static_cast<char*>(dst) + n1, data, n - n1);
+        }
+
+        // CRC-32 of n ring bytes at pos, following the wrap.
+        inline std::uint32_t ring_crc(const char* data, std::uint64_t cap, std::uint64_t pos,
+                                      std::uint64_t n) noexcept {
+            const std::size_t at = static_cast<std::size_t>(pos & (cap - 1));
+            const std::size_t n1 = (n < cap - at) ? static_cast<std::size_t>(n) : static_cast<std::size_t>(cap - at);
+            std::uint32_t st = crc32_update(crc32_init, bytes{reinterpret_cast<const std::byte*>(data + at), n1});
+            st = crc32_update(st, bytes{reinterpret_cast<const std::byte*>(data), static_cast<std::size_t>(n) - n1});
+            return crc32_final(st);
+        }
+
+        // Size of the intact frame at pos (header plus payload), or 0 if it would
+        // end past wpos or its check word (and, with payload, its CRC) is wrong.
+        inline std::uint64_t ring_frame_size(const char* data, std::uint64_t cap, std::uint64_t pos,
+                                             std::uint64_t wpos, bool payload) noexcept {
+            if (wpos - pos > cap || wpos - pos < frame_header) return 0;
+            std::uint32_t fh[3];
+            ring_get(data, cap, pos, fh, sizeof(fh));
+            const std::uint64_t n = fh[0] & ~frame_start;
+            if (fh[1] != frame_check(fh[0], pos) || n > wpos - pos - frame_header) return 0;
+            if (payload && fh[2] != ring_crc(data, cap, pos + frame_header, n)) return 0;
+            return frame_header + n;
+        }
+
+        inline bool ring_header_valid(const mmap_ring_header& h, std::uint64_t file_size) noexcept {
+            return std::memcmp(h.magic, ring_magic, sizeof(ring_magic)) == 0 &&
+                   h.version == mmap_ring_version &&
+                   h.header_size == sizeof(mmap_ring_header) &&
+                   h.capacity >= 64 && (h.capacity & (h.capacity - 1)) == 0 &&
+                   file_size >= sizeof(mmap_ring_header) + h.capacity &&
+                   h.checksum == ring_header_checksum(h);
+        }
+    }
+
+    // Writer side. Each write() becomes one frame; a write larger than a quarter
+    // of the ring is split. Reopening a valid file with the same capacity keeps
+    // its history. Single writer; not thread-safe.
+    struct mmap_ring_sink {
+        // capacity is rounded up to a power of two (minimum 64 bytes).
+        mmap_ring_sink(const char* path, std::size_t capacity) noexcept {
+            std::uint64_t cap = 64;
+            while (cap < capacity) cap <<= 1;
+            const std::uint64_t file_size = sizeof(mmap_ring_header) + cap;
+
+            fd_ = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd_ < 0) return;
+            struct stat st{};
+            if (::fstat(fd_, &st) != 0 ||
+                (static_cast<std::uint64_t>(st.st_size) != file_size &&
+                 ::ftruncate(fd_, static_cast<off_t>(file_size)) != 0)) {
+                close_fd();
+                return;
+            }
+            void* m = ::mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if (m == MAP_FAILED) {
+                close_fd();
+                return;
+            }
+            map_ = m;
+            map_size_ = file_size;
+            hdr_ = static_cast<mmap_ring_header*>(m);
+            data_ = static_cast<char*>(m) + sizeof(mmap_ring_header);
+            cap_ = cap;
+
+            if (detail::ring_header_valid(*hdr_, file_size) && hdr_->capacity == cap &&
+                hdr_->wpos - hdr_->tail <= cap) {
+                // Keep the history up to the first damaged frame and drop the rest.
+                tail_ = hdr_->tail;
+                wpos_ = tail_;
+                while (wpos_ != hdr_->wpos) {
+                    const std::uint64_t sz = detail::ring_frame_size(data_, cap_, wpos_, hdr_->wpos, true);
+                    if (sz == 0) break;
+                    wpos_ += sz;
+                }
+                hdr_->wpos = wpos_;
+            } else {
+                std::memset(hdr_, 0, sizeof(mmap_ring_header));
+                std::memcpy(hdr_->magic, detail::ring_magic, sizeof(detail::ring_magic));
+                hdr_->version = mmap_ring_version;
+                hdr_->header_size = sizeof(mmap_ring_header);
+                hdr_->capacity = cap;
+                hdr_->checksum = detail::ring_header_checksum(*hdr_);
+            }
+        }
+
+        mmap_ring_sink(const mmap_ring_sink&) = delete;
+        mmap_ring_sink& operator=(const mmap_ring_sink&) = delete;
+
+        ~mmap_ring_sink() {
+            if (map_) ::munmap(map_, map_size_);
+            close_fd();
+        }
+
+        bool is_open() const noexcept { return map_ != nullptr; }
+
+        result<std::size_t> write(bytes b) noexcept {
+            if (!map_) return std::unexpected(errc::io_error);
+            auto p = reinterpret_cast<const char*>(b.data());
+            std::size_t left = b.size();
+            const std::size_t max_payload = static_cast<std::size_t>(cap_ / 4);
+            while (left != 0) {
+                const std::size_t n = (left < max_payload) ? left : max_payload;
+                put_frame(p, n);
+                p += n;
+                left -= n;
+            }
+            if (b.size() != 0) at_record_start_ = (p[-1] == '\n');
+            return ok(b.size());
+        }
+
+        result<std::size_t> end_record() noexcept {
+            at_record_start_ = true;
+            return ok<std::size_t>(0u);
+        }
+
+        // Optional: schedule write-back to disk (power-loss durability).
+        result<std::size_t> sync() noexcept {
+            if (!map_) return std::unexpected(errc::io_error);
+            if (::msync(map_, map_size_, MS_ASYNC) != 0) return std::unexpected(errc::io_error);
+            return ok<std::size_t>(0u);
+        }
+
+      private:
+        void put_frame(const char* p, std::size_t n) noexcept {
+            const std::uint64_t need = detail::frame_header + n;
+            // Drop whole frames from the tail until the new one fits.
+            std::uint64_t t = tail_;
+            while (wpos_ + need - t > cap_) {
+                const std::uint64_t sz = detail::ring_frame_size(data_, cap_, t, wpos_, false);
+                if (sz == 0) {
+                    // Damaged history: drop all of it rather than walk garbage lengths.
+                    t = wpos_;
+                    break;
+                }
+                t += sz;
+            }
+            if (t != tail_) {
+                tail_ = t;
+                std::atomic_ref<std::uint64_t>{hdr_->tail}.store(t, std::memory_order_release);
+            }
+            std::uint32_t fh[3];
+            fh[0] = static_cast<std::uint32_t>(n) | (at_record_start_ ? detail::frame_start : 0u);
+            fh[1] = detail::frame_check(fh[0], wpos_);
+            fh[2] = crc32(bytes{reinterpret_cast<const std::byte*>(p), n});
+            detail::ring_put(data_, cap_, wpos_, fh, sizeof(fh));
+            detail::ring_put(data_, cap_, wpos_ + detail::frame_header, p, n);
+            wpos_ += need;
+            at_record_start_ = false;
+            // Publish only after the frame is complete: a crash mid-frame leaves it invisible.
+            std::atomic_ref<std::uint64_t>{hdr_->wpos}.store(wpos_, std::memory_order_release);
+        }
+
+        void close_fd() noexcept {
+            if (fd_ >= 0) ::close(fd_);
+            fd_ = -1;
+        }
+
+        int fd_ = -1;
+        void* map_ = nullptr;
+        std::size_t map_size_ = 0;
+        mmap_ring_header* hdr_ = nullptr;
+        char* data_ = nullptr;
+        std::uint64_t cap_ = 0;
+        std::uint64_t tail_ = 0;   // private copies; the header is write-only here
+        std::uint64_t wpos_ = 0;
+        bool at_record_start_ = true;
+    };
+
+    // Reader side: recovers the retained history from a ring file written by a
+    // (possibly dead) mmap_ring_sink. Output starts at the first frame that
+    // begins a record and stops at the first frame whose header or payload CRC
+    // fails validation.
+    // Returns errc::invalid_format for a file with a bad or unknown header.
+    template <Sink S>
+    result<std::size_t> dump_mmap_ring(const char* path, S& s) noexcept {
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return std::unexpected(errc::io_error);
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || static_cast<std::uint64_t>(st.st_size) < sizeof(mmap_ring_header)) {
+            ::close(fd);
+            return std::unexpected(errc::invalid_format);
+        }
+        const auto file_size = static_cast<std::size_t>(st.st_size);
+        void* m = ::mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (m == MAP_FAILED) return std::unexpected(errc::io_error);
+
+        auto* hdr = static_cast<const mmap_ring_header*>(m);
+        const char* data = static_cast<const char*>(m) + sizeof(mmap_ring_header);
+        result<std::size_t> res = ok<std::size_t>(0u);
+        if (!detail::ring_header_valid(*hdr, file_size)) {
+            res = std::unexpected(errc::invalid_format);
+        } else {
+            const std::uint64_t cap = hdr->capacity;
+            const std::uint64_t wpos = std::atomic_ref<const std::uint64_t>{hdr->wpos}.load(std::memory_order_acquire);
+            std::uint64_t pos = std::atomic_ref<const std::uint64_t>{hdr->tail}.load(std::memory_order_acquire);
+            if (wpos - pos > cap) pos = wpos; // inconsistent indices: nothing trustworthy
+            std::size_t total = 0;
+            bool started = false;
+            while (wpos != pos) {
+                const std::uint64_t sz = detail::ring_frame_size(data, cap, pos, wpos, true);
+                if (sz == 0) break;
+                std::uint32_t len_flags = 0;
+                detail::ring_get(data, cap, pos, &len_flags, sizeof(len_flags));
+                const std::uint64_t n = sz - detail::frame_header;
+                started = started || (len_flags & detail::frame_start) != 0;
+                if (started) {
+                    const std::size_t at = static_cast<std::size_t>((pos + detail::frame_header) & (cap - 1));
+                    const std::size_t n1 = (n < cap - at) ? static_cast<std::size_t>(n) : static_cast<std::size_t>(cap - at);
+                    auto r = s.write(bytes{reinterpret_cast<const std::byte*>(data + at), n1});
+                    if (r && n1 < n) {
+                        total += *r;
+                        r = s.write(bytes{reinterpret_cast<const std::byte*>(data), static_cast<std::size_t>(n) - n1});
+                    }
+                    if (!r) {
+                        res = std::unexpected(r.error());
+                        break;
+                    }
+                    total += *r;
+                }
+                pos += detail::frame_header + n;
+            }
+            if (res) res = ok(total);
+        }
+        ::munmap(m, file_size);
+        return res;
+    }
+
+
+    // ------------------------------------------------------------------
+    // Shared-memory log channel: lock-free SPSC ring in POSIX shared memory.
+    // The logging process only copies frames into the ring (memcpy + release
+    // store); an out-of-process collector (examples/linux/out-collector.cpp)
+    // drains it to disk or terminal. Frames are u32 length + payload, one per
+    // write(). A full ring drops the write (counted in header.dropped) and
+    // reports errc::would_block instead of blocking the producer; a write that
+    // can never fit in the ring fails with errc::buffer_overflow.
+
+    struct shm_channel_header {
+        char magic[8];                          // "OUTSPSC\0"
+        std::uint32_t version;                  // shm_channel_version
+        std::uint32_t header_size;              // sizeof(shm_channel_header)
+        std::uint64_t capacity;                 // data bytes, power of two
+        std::uint64_t dropped;                  // writes rejected because the ring was full
+        alignas(64) std::uint64_t head;         // producer position (absolute)
+        std::uint32_t seq;                      // futex word, bumped on wake-up
+        std::uint32_t waiting;                  // consumer sleeps on seq
+        alignas(64) std::uint64_t tail;         // consumer position (absolute)
+    };
+
+    inline constexpr std::uint32_t shm_channel_version = 1;
+
+    namespace detail {
+        inline constexpr char spsc_magic[8] = {'O', 'U', 'T', 'S', 'P', 'S', 'C', '\0'};
+
+        inline void futex_wake(std::uint32_t* addr) noexcept {
+#if defined(__linux__)
+            ::syscall(SYS_futex, addr, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+            (void)addr;
+#endif
+        }
+
+        // Maps a shared memory object; size == 0 maps the existing object and
+        // reports its size back. Returns nullptr on failure.
+        inline void* shm_map(const char* name, std::uint64_t& size, bool create) noexcept {
+            const int fd = ::shm_open(name, create ? (O_RDWR | O_CREAT) : O_RDWR, 0600);
+            if (fd < 0) return nullptr;
+            struct stat st{};
+            void* m = nullptr;
+            if (::fstat(fd, &st) == 0) {
+                if (size == 0) size = static_cast<std::uint64_t>(st.st_size);
+                if (size >= sizeof(shm_channel_header) &&
+                    (static_cast<std::uint64_t>(st.st_size) == size ||
+                     (create && ::ftruncate(fd, static_cast<off_t>(size)) == 0))) {
+                    m = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                    if (m == MAP_FAILED) m = nullptr;
+                }
+            }
+            ::close(fd);
+            return m;
+        }
+    }
+
+    // Producer side. Single writer per channel; not thread-safe.
+    struct shm_channel_sink {
+        // name follows shm_open() rules ("/out-log"); capacity is rounded up to a
+        // power of two. An existing channel with the same capacity is reused.
+        shm_channel_sink(const char* name, std::size_t capacity) noexcept {
+            std::uint64_t cap = 64;
+            while (cap < capacity) cap <<= 1;
+            size_ = sizeof(shm_channel_header) + cap;
+            void* m = detail::shm_map(name, size_, true);
+            if (!m) return;
+            hdr_ = static_cast<shm_channel_header*>(m);
+            data_ = static_cast<char*>(m) + sizeof(shm_channel_header);
+            cap_ = cap;
+            if (std::memcmp(hdr_->magic, detail::spsc_magic, sizeof(detail::spsc_magic)) != 0 ||
+                hdr_->version != shm_channel_version || hdr_->header_size != sizeof(shm_channel_header) ||
+                hdr_->capacity != cap) {
+                std::memset(hdr_, 0, sizeof(shm_channel_header));
+                hdr_->version = shm_channel_version;
+                hdr_->header_size = sizeof(shm_channel_header);
+                hdr_->capacity = cap;
+                // Magic last: a collector attaching meanwhile sees a complete header.
+                std::atomic_thread_fence(std::memory_order_release);
+                std::memcpy(hdr_->magic, detail::spsc_magic, sizeof(detail::spsc_magic));
+            }
+            head_ = std::atomic_ref<std::uint64_t>{hdr_->head}.load(std::memory_order_relaxed);
+            tail_cache_ = std::atomic_ref<std::uint64_t>{hdr_->tail}.load(std::memory_order_acquire);
+        }
+
+        shm_channel_sink(const shm_channel_sink&) = delete;
+        shm_channel_sink& operator=(const shm_channel_sink&) = delete;
+
+        ~shm_channel_sink() {
+            if (hdr_) ::munmap(hdr_, size_);
+        }
+
+        bool is_open() const noexcept { return hdr_ != nullptr; }
+
+        result<std::size_t> write(bytes b) noexcept {
+            if (!hdr_) return std::unexpected(errc::io_error);
+            const std::uint64_t need = sizeof(std::uint32_t) + b.size();
+            if (need > cap_) {
+                std::atomic_ref<std::uint64_t>{hdr_->dropped}.fetch_add(1, std::memory_order_relaxed);
+                return std::unexpected(errc::buffer_overflow);
+            }
+            if (head_ + need - tail_cache_ > cap_) {
+                // Only touch the consumer's cache line when the ring looks full.
+                tail_cache_ = std::atomic_ref<std::uint64_t>{hdr_->tail}.load(std::memory_order_acquire);
+                if (head_ + need - tail_cache_ > cap_) {
+                    std::atomic_ref<std::uint64_t>{hdr_->dropped}.fetch_add(1, std::memory_order_relaxed);
+                    return std::unexpected(errc::would_block);
+                }
+            }
+            const auto len = static_cast<std::uint32_t>(b.size());
+            detail::ring_put(data_, cap_, head_, &len, sizeof(len));
+            detail::ring_put(data_, cap_, head_ + sizeof(len), b.data(), b.size());
+            head_ += need;
+            std::atomic_ref<std::uint64_t>{hdr_->head}.store(head_, std::memory_order_release);
+            // Dekker-style handshake with shm_channel_reader::wait().
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (std::atomic_ref<std::uint32_t>{hdr_->waiting}.load(std::memory_order_relaxed) != 0) {
+                std::atomic_ref<std::uint32_t>{hdr_->seq}.fetch_add(1, std::memory_order_release);
+                detail::futex_wake(&hdr_->seq);
+            }
+            return ok(b.size());
+        }
+
+      private:
+        shm_channel_header* hdr_ = nullptr;
+        char* data_ = nullptr;
+        std::uint64_t size_ = 0;
+        std::uint64_t cap_ = 0;
+        std::uint64_t head_ = 0;        // private copy of hdr_->head
+        std::uint64_t tail_cache_ = 0;  // last observed hdr_->tail
+    };
+
+    // Consumer side (collector process). Attaches to a channel created by the producer.
+    struct shm_channel_reader {
+        explicit shm_channel_reader(const char* name) noexcept {
+            std::uint64_t size = 0;
+            void* m = detail::shm_map(name, size, false);
+            if (!m) return;
+            auto* h = static_cast<shm_channel_header*>(m);
+            if (std::memcmp(h->magic, detail::spsc_magic, sizeof(detail::spsc_magic)) != 0 ||
+                h->version != shm_channel_version || h->header_size != sizeof(shm_channel_header) ||
+                h->capacity < 64 || (h->capacity & (h->capacity - 1)) != 0 ||
+                sizeof(shm_channel_header) + h->capacity != size) {
+                ::munmap(m, size);
+                return;
+            }
+            hdr_ = h;
+            cap_ = h->capacity;
+            size_ = size;
+            data_ = static_cast<const char*>(m) + sizeof(shm_channel_header);
+        }
+
+        shm_channel_reader(const shm_channel_reader&) = delete;
+        shm_channel_reader& operator=(const shm_channel_reader&) = delete;
+
+        ~shm_channel_reader() {
+            if (hdr_) ::munmap(hdr_, size_);
+        }
+
+        bool is_open() const noexcept { return hdr_ != nullptr; }
+        std::uint64_t dropped() const noexcept {
+            return std::atomic_ref<std::uint64_t>{hdr_->dropped}.load(std::memory_order_relaxed);
+        }
+
+        // Moves every published frame into s; returns the payload bytes written.
+        // Positions and lengths come from memory the producer can scribble on, so
+        // each frame must lie within the published span before s sees it. A
+        // corrupt ring is skipped up to head and reported as errc::io_error.
+        template <Sink S>
+        result<std::size_t> poll(S& s) noexcept {
+            if (!hdr_) return std::unexpected(errc::io_error);
+            const std::uint64_t head = std::atomic_ref<std::uint64_t>{hdr_->head}.load(std::memory_order_acquire);
+            std::uint64_t tail = std::atomic_ref<std::uint64_t>{hdr_->tail}.load(std::memory_order_relaxed);
+            std::size_t total = 0;
+            while (tail != head) {
+                std::uint32_t len = 0;
+                const std::uint64_t avail = head - tail;
+                if (avail > cap_ || avail < sizeof(len)) return skip_to(head);
+                detail::ring_get(data_, cap_, tail, &len, sizeof(len));
+                if (len > avail - sizeof(len)) return skip_to(head);
+                const std::size_t at = static_cast<std::size_t>((tail + sizeof(len)) & (cap_ - 1));
+                const std::size_t n1 = (len < cap_ - at) ? len : static_cast<std::size_t>(cap_ - at);
+                auto r = s.write(bytes{reinterpret_cast<const std::byte*>(data_ + at), n1});
+                if (r && n1 < len) {
+                    total += *r;
+                    r = s.write(bytes{reinterpret_cast<const std::byte*>(data_), len - n1});
+                }
+                if (!r) return std::unexpected(r.error());
+                total += *r;
+                tail += sizeof(len) + len;
+                std::atomic_ref<std::uint64_t>{hdr_->tail}.store(tail, std::memory_order_release);
+            }
+            return ok(total);
+        }
+
+        // Sleeps until the producer publishes a frame or timeout_ms elapses
+        // (futex on Linux; elsewhere a plain sleep of timeout_ms).
+        void wait(int timeout_ms) noexcept {
+            if (!hdr_) return;
+#if defined(__linux__)
+            const std::uint32_t seq = std::atomic_ref<std::uint32_t>{hdr_->seq}.load(std::memory_order_acquire);
+            std::atomic_ref<std::uint32_t>{hdr_->waiting}.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (std::atomic_ref<std::uint64_t>{hdr_->head}.load(std::memory_order_relaxed) ==
+                std::atomic_ref<std::uint64_t>{hdr_->tail}.load(std::memory_order_relaxed)) {
+                timespec ts{timeout_ms / 1000, static_cast<long>(timeout_ms % 1000) * 1000000L};
+                ::syscall(SYS_futex, &hdr_->seq, FUTEX_WAIT, seq, &ts, nullptr, 0);
+            }
+            std::atomic_ref<std::uint32_t>{hdr_->waiting}.store(0, std::memory_order_relaxed);
+#else
+            timespec ts{timeout_ms / 1000, static_cast<long>(timeout_ms % 1000) * 1000000L};
+            ::nanosleep(&ts, nullptr);
+#endif
+        }
+
+      private:
+        result<std::size_t> skip_to(std::uint64_t head) noexcept {
+            std::atomic_ref<std::uint64_t>{hdr_->tail}.store(head, std::memory_order_release);
+            return std::unexpected(errc::io_error);
+        }
+
+        shm_channel_header* hdr_ = nullptr;
+        const char* data_ = nullptr;
+        std::uint64_t size_ = 0;
+        std::uint64_t cap_ = 0;
+    };
+
+
+    // ------------------------------------------------------------------
+    // Non-blocking fd sink for pipes/sockets owned by an event loop. The fd is
+    // switched to O_NONBLOCK (which affects every user of the open file
+    // description). On EAGAIN the unsent bytes are parked in a bounded N-byte
+    // pending buffer; they are retried first on the next write() or by
+    // poll_flush() (call it when the loop reports the fd writable). A write that
+    // does not fit into the pending buffer fails with errc::would_block: it is
+    // dropped whole, or truncated if part of it already reached the fd. Accepted
+    // bytes keep their order. The fd is not owned.
+    template <std::size_t N = 4096>
+    struct nonblocking_fd_sink {
+        explicit nonblocking_fd_sink(int fd) noexcept : fd_(fd) {
+            const int fl = ::fcntl(fd_, F_GETFL);
+            if (fl >= 0 && (fl & O_NONBLOCK) == 0) (void)::fcntl(fd_, F_SETFL, fl | O_NONBLOCK);
+        }
+
+        result<std::size_t> write(bytes b) noexcept {
+            if (len_ != 0) {
+                auto r = poll_flush();
+                if (!r) return std::unexpected(r.error());
+            }
+            auto p = reinterpret_cast<const char*>(b.data());
+            std::size_t n = b.size();
+            bool partial = false;
+            if (len_ == 0) {
+                auto r = send_some(p, n);
+                if (!r) return std::unexpected(r.error());
+                if (*r == n) return ok(b.size());
+                partial = *r != 0;
+                p += *r;
+                n -= *r;
+            }
+            // Drop an untouched write whole; finish a started one as far as possible.
+            if (n > N - len_ && !partial) return std::unexpected(errc::would_block);
+            if (off_ != 0 && n > N - (off_ + len_)) {
+                std::memmove(buf_.data(), buf_.data() + off_, len_);
+                off_ = 0;
+            }
+            const std::size_t keep = (n < N - len_) ? n : N - len_;
+            std::memcpy(buf_.data() + off_ + len_, p, keep);
+            len_ += keep;
+            if (keep < n) return std::unexpected(errc::would_block);
+            return ok(b.size());
+        }
+
+        // Retries the pending bytes; returns how many were sent this time.
+        result<std::size_t> poll_flush() noexcept {
+            if (len_ == 0) return ok<std::size_t>(0u);
+            auto r = send_some(buf_.data() + off_, len_);
+            if (!r) return r;
+            off_ += *r;
+            len_ -= *r;
+            if (len_ == 0) off_ = 0;
+            return r;
+        }
+
+        // Flushable: never blocks; bytes the fd cannot take yet stay pending().
+        result<std::size_t> flush() noexcept { return poll_flush(); }
+
+        std::size_t pending() const noexcept { return len_; }
+        int fd() const noexcept { return fd_; }
+
+      private:
+        // Writes until done or EAGAIN; returns the bytes written.
+        result<std::size_t> send_some(const char* p, std::size_t n) noexcept {
+            std::size_t done = 0;
+            while (done < n) {
+                const ::ssize_t w = ::write(fd_, p + done, n - done);
+                if (w >= 0) {
+                    done += static_cast<std::size_t>(w);
+                } else if (errno == EINTR) {
+                    continue;
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                } else {
+                    return std::unexpected(errc::io_error);
+                }
+            }
+            return ok(done);
+        }
+
+        int fd_;
+        std::array<char, N> buf_{};
+        std::size_t off_ = 0;
+        std::size_t len_ = 0;
+    };
+
+
+    // ------------------------------------------------------------------
+    // Multi-process append: every logger record reaches the file as exactly one
+    // write(2) on an O_APPEND descriptor, so records from several worker
+    // processes never interleave (no lock file needed). Max defaults to PIPE_BUF,
+    // which also keeps the guarantee on pipes/FIFOs. Records longer than Max are
+    // split: each non-final fragment ends with " \\\n" and the next one starts
+    // with "+ ", so readers can rejoin them. Bytes written outside a logger
+    // record (out::print/vprint) are staged until flush() or the next
+    // begin_record(), and then go out as their own write(2): they never join a
+    // record, but only logger records are kept whole. This sink has no
+    // write_ansi(), so styled loggers emit no escape sequences here.
+    template <std::size_t Max = PIPE_BUF>
+    struct append_record_sink {
+        static_assert(Max >= 64, "Max too small for record fragments");
+
+        explicit append_record_sink(const char* path) noexcept
+            : fd_(::open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644)) {}
+
+        append_record_sink(const append_record_sink&) = delete;
+        append_record_sink& operator=(const append_record_sink&) = delete;
+
+        ~append_record_sink() {
+            (void)flush();
+            if (fd_ >= 0) ::close(fd_);
+        }
+
+        bool is_open() const noexcept { return fd_ >= 0; }
+
+        result<std::size_t> write(bytes b) noexcept {
+            if (fd_ < 0) return std::unexpected(errc::io_error);
+            auto p = reinterpret_cast<const char*>(b.data());
+            std::size_t left = b.size();
+            while (left != 0) {
+                if (len_ == payload_max) {
+                    // More bytes for a full buffer: close this fragment, continue in the next.
+                    std::memcpy(buf_.data() + len_, cont_tail.data(), cont_tail.size());
+                    auto r = emit(len_ + cont_tail.size());
+                    if (!r) return std::unexpected(r.error());
+                    std::memcpy(buf_.data(), cont_head.data(), cont_head.size());
+                    len_ = cont_head.size();
+                }
+                const std::size_t room = payload_max - len_;
+                const std::size_t n = (left < room) ? left : room;
+                std::memcpy(buf_.data() + len_, p, n);
+                len_ += n;
+                p += n;
+                left -= n;
+            }
+            return ok(b.size());
+        }
+
+        // Emits staged non-record output first, so the record starts in an empty buffer.
+        void begin_record(level, std::string_view) noexcept { (void)flush(); }
+
+        result<std::size_t> end_record() noexcept { return flush(); }
+
+        // Writes staged bytes now; the logger calls end_record() first, so this is
+        // only non-empty for output written outside a logger record.
+        result<std::size_t> flush() noexcept {
+            if (len_ == 0) return ok<std::size_t>(0u);
+            return emit(len_);
+        }
+
+      private:
+        static constexpr std::string_view cont_tail = " \\\n";
+        static constexpr std::string_view cont_head = "+ ";
+        static constexpr std::size_t payload_max = Max - cont_tail.size();
+
+        // One write(2) per fragment; a short write (signal, disk full) is
+        // completed best-effort and loses only the atomicity of that fragment.
+        result<std::size_t> emit(std::size_t n) noexcept {
+            len_ = 0;
+            std::size_t done = 0;
+            while (done < n) {
+                const ::ssize_t w = ::write(fd_, buf_.data() + done, n - done);
+                if (w < 0) {
+                    if (errno == EINTR) continue;
+                    return std::unexpected(errc::io_error);
+                }
+                done += static_cast<std::size_t>(w);
+            }
+            return ok<std::size_t>(0u);
+        }
+
+        int fd_;
+        std::array<char, Max> buf_{};
+        std::size_t len_ = 0;
+    };
+
+}
+#endif
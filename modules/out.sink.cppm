@@ -1,6 +1,8 @@
 module;
 #include <span>
 #include <array>
+#include <atomic>
+#include <cstdint>
 #include <string_view>
 #include <expected>
 #include <cstring>
@@ -13,6 +15,17 @@ export module out.sink;
 // If you need functionality from a higher layer, add an extension point in this layer instead.
 
 import out.core;
+
+// CRC-32 table: slice-by-8 (8 KiB, ~8 bytes per step) on 64-bit hosts, a
+// 16-entry nibble table (64 bytes) elsewhere. Define one to override.
+#if !defined(OUT_CRC_SLICE8) && !defined(OUT_CRC_NIBBLE)
+#if UINTPTR_MAX > 0xFFFFFFFFu
+#define OUT_CRC_SLICE8
+#else
+#define OUT_CRC_NIBBLE
+#endif
+#endif
+
 // TODO: add compile-time endian conversion helpers.
 export namespace out {
 
@@ -29,6 +42,13 @@ export namespace out {
         { s.flush() } -> std::same_as<result<std::size_t>>;
     };
 
+    // Record-framing sinks: end_record() is called once after all bytes of a
+    // logger record were written, so the sink can close a datagram/frame.
+    template <class S>
+    concept RecordSink = Sink<S> && requires(S& s) {
+        { s.end_record() } -> std::same_as<result<std::size_t>>;
+    };
+
     // Convenience: write from string_view.
     template <Sink S>
     inline result<std::size_t> write(S& s, std::string_view sv) noexcept {
@@ -127,18 +147,19 @@ export namespace out {
 
         result<std::size_t> write(bytes b) noexcept {
             auto data = reinterpret_cast<const char*>(b.data());
-            for (std::size_t i = 0; i < b.size(); ++i) {
-                if (pos >= BufSize) {
-                    auto r = flush();
-                    if (!r) return std::unexpected(r.error());
-                }
-
-                buf[pos++] = data[i];
-
-                if (data[i] == '\n') {
-                    auto r = flush();
-                    if (!r) return std::unexpected(r.error());
+            std::size_t left = b.size();
+            while (left != 0) {
+                // memchr is vectorized by most libcs; copy whole runs instead of bytes.
+                auto nl = static_cast<const char*>(std::memchr(data, '\n', left));
+                const std::size_t n = nl ? static_cast<std::size_t>(nl - data) + 1 : left;
+                auto r = stage(data, n);
+                if (!r) return std::unexpected(r.error());
+                if (nl) {
+                    auto rf = flush();
+                    if (!rf) return std::unexpected(rf.error());
                 }
+                data += n;
+                left -= n;
             }
             return ok(b.size());
         }
@@ -155,6 +176,684 @@ export namespace out {
 
         // Destructor flushes best-effort; errors are intentionally ignored.
         ~line_buffered_sink() { (void)flush(); }
+
+      private:
+        // Copies [p, p + n) into the line buffer, flushing whenever it fills up.
+        // Runs that cannot fit an empty buffer bypass it and go straight to base.
+        result<std::size_t> stage(const char* p, std::size_t n) noexcept {
+            while (n != 0) {
+                if (pos == 0 && n >= BufSize) {
+                    return base.write(bytes{reinterpret_cast<const std::byte*>(p), n});
+                }
+                const std::size_t space = BufSize - pos;
+                const std::size_t k = (n < space) ? n : space;
+                std::memcpy(buf.data() + pos, p, k);
+                pos += k;
+                p += k;
+                n -= k;
+                if (pos == BufSize) {
+                    auto r = flush();
+                    if (!r) return std::unexpected(r.error());
+                }
+            }
+            return ok<std::size_t>(0u);
+        }
+    };
+
+
+    // 5) DMA double buffer: producers fill one half while the other half is on the wire.
+    // Dma is the platform hook:
+    //   bool start(const std::byte* p, std::size_t n) noexcept; // begin async transfer
+    // and the platform must call on_transfer_done() from its completion callback
+    // (e.g. HAL_UART_TxCpltCallback). The callback itself swaps halves and starts the
+    // next transfer, so a busy link drains without help from the producer.
+    // Single producer; write() must not be called from the completion callback.
+    // A producer that fills its half while the other one is in flight spins until
+    // the transfer completes. Needs lock-free 32-bit CAS (ARMv7-M or a host CPU).
+    template <class D>
+    concept DmaTransport = requires(D& d, const std::byte* p, std::size_t n) {
+        { d.start(p, n) } -> std::same_as<bool>;
+    };
+
+    template <DmaTransport Dma, std::size_t N = 256>
+    struct dma_double_buffer_sink {
+        static_assert(N != 0 && N < (1u << 30), "half size out of range");
+
+        explicit dma_double_buffer_sink(Dma& d) noexcept : dma(d) {}
+
+        dma_double_buffer_sink(const dma_double_buffer_sink&) = delete;
+        dma_double_buffer_sink& operator=(const dma_double_buffer_sink&) = delete;
+
+        result<std::size_t> write(bytes b) noexcept {
+            auto p = b.data();
+            std::size_t left = b.size();
+            std::uint32_t st = state.load(std::memory_order_acquire);
+            while (left != 0) {
+                const std::uint32_t half = (st & fill_bit) ? 1u : 0u;
+                const std::size_t len = st & len_mask;
+                if (len == N) {
+                    // Both halves taken: wait for the completion callback to swap.
+                    auto r = kick(st);
+                    if (!r) return std::unexpected(r.error());
+                    st = state.load(std::memory_order_acquire);
+                    continue;
+                }
+                const std::size_t n = (left < N - len) ? left : N - len;
+                // Bytes past the committed length are private until the CAS below.
+                std::memcpy(bufs[half].data() + len, p, n);
+                const std::uint32_t next = st + static_cast<std::uint32_t>(n);
+                if (!state.compare_exchange_weak(st, next, std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+                    continue; // callback swapped halves meanwhile; copy again.
+                }
+                st = next;
+                p += n;
+                left -= n;
+            }
+            auto r = kick(st);
+            if (!r) return std::unexpected(r.error());
+            return ok(b.size());
+        }
+
+        // Starts a transfer if the link is idle; does not wait for completion.
+        result<std::size_t> flush() noexcept {
+            auto r = kick(state.load(std::memory_order_acquire));
+            if (!r) return std::unexpected(r.error());
+            return ok<std::size_t>(0u);
+        }
+
+        // Completion callback (ISR or DMA thread): swap halves and chain the next transfer.
+        void on_transfer_done() noexcept {
+            std::uint32_t st = state.load(std::memory_order_acquire);
+            for (;;) {
+                const std::size_t len = st & len_mask;
+                if (len == 0) {
+                    if (state.compare_exchange_weak(st, st & ~busy_bit, std::memory_order_acq_rel,
+                                                    std::memory_order_acquire)) return;
+                    continue;
+                }
+                const std::uint32_t next = (st ^ fill_bit) & ~len_mask;
+                if (state.compare_exchange_weak(st, next, std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+                    if (!dma.start(bufs[(st & fill_bit) ? 1u : 0u].data(), len)) {
+                        state.fetch_and(~busy_bit, std::memory_order_acq_rel);
+                    }
+                    return;
+                }
+            }
+        }
+
+        // True while a transfer is in flight.
+        bool busy() const noexcept { return (state.load(std::memory_order_acquire) & busy_bit) != 0; }
+
+        // Spins until both halves are on the wire and done (e.g. before sleep/reset).
+        result<std::size_t> drain() noexcept {
+            for (;;) {
+                const std::uint32_t st = state.load(std::memory_order_acquire);
+                if (st == (st & fill_bit)) return ok<std::size_t>(0u);
+                auto r = kick(st);
+                if (!r) return std::unexpected(r.error());
+            }
+        }
+
+      private:
+        static constexpr std::uint32_t busy_bit = 1u << 31;
+        static constexpr std::uint32_t fill_bit = 1u << 30;
+        static constexpr std::uint32_t len_mask = fill_bit - 1u;
+
+        // Idle link + pending bytes: hand the fill half to the DMA and swap.
+        result<std::size_t> kick(std::uint32_t st) noexcept {
+            while (!(st & busy_bit) && (st & len_mask) != 0) {
+                const std::uint32_t next = ((st ^ fill_bit) & ~len_mask) | busy_bit;
+                if (!state.compare_exchange_weak(st, next, std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) continue;
+                if (!dma.start(bufs[(st & fill_bit) ? 1u : 0u].data(), st & len_mask)) {
+                    state.fetch_and(~busy_bit, std::memory_order_acq_rel);
+                    return std::unexpected(errc::io_error);
+                }
+                break;
+            }
+            return ok<std::size_t>(0u);
+        }
+
+        Dma& dma;
+        std::array<std::array<std::byte, N>, 2> bufs{};
+        // bit31: transfer in flight, bit30: half being filled, bits0-29: its length.
+        std::atomic<std::uint32_t> state{0};
+    };
+
+
+    // 6) Flight recorder ring: always accepts writes, overwriting the oldest lines.
+    // The retained history always starts at a line boundary ('\n'), so dump_to()
+    // never emits a torn first line; the newest (unterminated) line is included.
+    // N must be a power of two. Not thread-safe; guard it like any other sink.
+    template <std::size_t N = 4096>
+    struct ring_sink {
+        static_assert(N != 0 && (N & (N - 1)) == 0, "ring size must be a power of two");
+
+        result<std::size_t> write(bytes b) noexcept {
+            auto data = reinterpret_cast<const char*>(b.data());
+            const std::size_t n = b.size();
+            const std::size_t end = wpos + n;
+            if (resync) {
+                // History lost the start of the current line: skip to the next one.
+                auto nl = static_cast<const char*>(std::memchr(data, '\n', n));
+                if (nl) {
+                    start = wpos + static_cast<std::size_t>(nl - data) + 1;
+                    resync = false;
+                } else {
+                    start = end;
+                }
+            }
+            if (end - start > N) drop_to_boundary(data, n);
+            // Only the last N bytes of an oversized write can survive.
+            const std::size_t keep = (n < N) ? n : N;
+            copy_in(data + (n - keep), keep, end - keep);
+            wpos = end;
+            return ok(b.size());
+        }
+
+        // Emits the retained history (oldest first) in at most two writes.
+        template <Sink S>
+        result<std::size_t> dump_to(S& s) const noexcept {
+            const std::size_t len = size();
+            const std::size_t first = start & (N - 1);
+            const std::size_t n1 = (len < N - first) ? len : N - first;
+            std::size_t total = 0;
+            if (n1 != 0) {
+                auto r = s.write(bytes{reinterpret_cast<const std::byte*>(buf.data() + first), n1});
+                if (!r) return std::unexpected(r.error());
+                total += *r;
+            }
+            if (len > n1) {
+                auto r = s.write(bytes{reinterpret_cast<const std::byte*>(buf.data()), len - n1});
+                if (!r) return std::unexpected(r.error());
+                total += *r;
+            }
+            return ok(total);
+        }
+
+        std::size_t size() const noexcept { return wpos - start; }
+        void clear() noexcept { start = wpos; resync = false; }
+
+      private:
+        void copy_in(const char* p, std::size_t n, std::size_t pos) noexcept {
+            const std::size_t at = pos & (N - 1);
+            const std::size_t n1 = (n < N - at) ? n : N - at;
+            std::memcpy(buf.data() + at, p, n1);
+            std::memcpy(buf.data(), p + n1, n - n1);
+        }
+
+        // Moves start to the first line start that leaves room for n new bytes.
+        // Runs before the incoming bytes are copied, so both the old ring bytes
+        // and the incoming chunk are still intact. A line starts after a '\n'.
+        void drop_to_boundary(const char* data, std::size_t n) noexcept {
+            std::size_t left = (n <= N) ? N + 1 - n : 0; // old bytes from end - N - 1
+            std::size_t pos = wpos - left;
+            while (left != 0) {
+                const std::size_t at = pos & (N - 1);
+                const std::size_t span = (left < N - at) ? left : N - at;
+                auto nl = static_cast<const char*>(std::memchr(buf.data() + at, '\n', span));
+                if (nl) {
+                    start = pos + static_cast<std::size_t>(nl - (buf.data() + at)) + 1;
+                    return;
+                }
+                pos += span;
+                left -= span;
+            }
+            const std::size_t off = (n <= N) ? 0 : n - N - 1;
+            auto nl = static_cast<const char*>(std::memchr(data + off, '\n', n - off));
+            if (nl) {
+                start = wpos + static_cast<std::size_t>(nl - data) + 1;
+            } else {
+                start = wpos + n;
+                resync = true;
+            }
+        }
+
+        std::array<char, N> buf{};
+        std::size_t wpos = 0;   // absolute write position (wraps modulo 2^bits)
+        std::size_t start = 0;  // absolute position of the oldest retained line
+        bool resync = false;    // true while the current line lost its beginning
+    };
+
+
+    // 7) COBS framing: one self-delimiting frame per logger record.
+    // Bytes are COBS-encoded as they arrive and end_record() closes the frame with
+    // a 0x00 delimiter, so a receiver on a lossy link resyncs at the next zero
+    // instead of guessing at newlines. Scratch is N bytes (no heap); it must hold
+    // one full COBS block (code + 254 bytes). Encoded bytes reach the base sink
+    // whenever the scratch fills up and at the end of every record.
+    template <Sink BaseSink, std::size_t N = 256>
+    struct cobs_framing_sink {
+        static_assert(N >= 256, "cobs scratch must hold a full block");
+
+        BaseSink& base;
+
+        explicit cobs_framing_sink(BaseSink& s) noexcept : base(s) {}
+
+        cobs_framing_sink(const cobs_framing_sink&) = delete;
+        cobs_framing_sink& operator=(const cobs_framing_sink&) = delete;
+
+        result<std::size_t> write(bytes b) noexcept {
+            auto data = reinterpret_cast<const unsigned char*>(b.data());
+            std::size_t left = b.size();
+            while (left != 0) {
+                if (!in_frame) {
+                    auto r = open_block();
+                    if (!r) return std::unexpected(r.error());
+                    in_frame = true;
+                }
+                if (*data == 0) {
+                    ++data;
+                    --left;
+                    auto r = close_block();
+                    if (!r) return std::unexpected(r.error());
+                    continue;
+                }
+                // Copy the run of non-zero bytes that still fits into the open block.
+                std::size_t run = 0xFF - code;
+                if (run > left) run = left;
+                if (auto z = static_cast<const unsigned char*>(std::memchr(data, 0, run))) {
+                    run = static_cast<std::size_t>(z - data);
+                }
+                std::memcpy(buf.data() + len, data, run);
+                len += run;
+                code += run;
+                data += run;
+                left -= run;
+                if (code == 0xFF) {
+                    auto r = close_block();
+                    if (!r) return std::unexpected(r.error());
+                }
+            }
+            return ok(b.size());
+        }
+
+        // Passes the logger's record hook (level, domain) on to a base that has one.
+        template <class Level, class B = BaseSink>
+          requires requires(B& b, Level l, std::string_view d) { b.begin_record(l, d); }
+        void begin_record(Level l, std::string_view domain) noexcept { base.begin_record(l, domain); }
+
+        // Closes the current frame (an empty record becomes the frame 01 00).
+        result<std::size_t> end_record() noexcept {
+            if (!in_frame) {
+                auto r = open_block();
+                if (!r) return std::unexpected(r.error());
+            }
+            buf[code_at] = static_cast<unsigned char>(code);
+            in_frame = false;
+            if (len == N) {
+                auto r = forward(len);
+                if (!r) return std::unexpected(r.error());
+            }
+            buf[len++] = 0;
+            auto r = forward(len);
+            if (!r) return std::unexpected(r.error());
+            if constexpr (RecordSink<BaseSink>) {
+                return base.end_record();
+            } else {
+                return ok<std::size_t>(0u);
+            }
+        }
+
+        // Forwards the encoded bytes of completed blocks. Like line_buffered_sink,
+        // it does NOT call base.flush(), and it never closes the current frame.
+        result<std::size_t> flush() noexcept {
+            return forward(in_frame ? code_at : len);
+        }
+
+        // Destructor closes an open frame best-effort; errors are intentionally ignored.
+        ~cobs_framing_sink() {
+            if (in_frame) (void)end_record();
+        }
+
+      private:
+        // Starts a block, first forwarding completed blocks if a full one may not fit.
+        result<std::size_t> open_block() noexcept {
+            if (len + 0xFF > N) {
+                auto r = forward(len);
+                if (!r) return r;
+            }
+            code_at = len;
+            buf[len++] = 0;
+            code = 1;
+            return ok<std::size_t>(0u);
+        }
+
+        result<std::size_t> close_block() noexcept {
+            buf[code_at] = static_cast<unsigned char>(code);
+            return open_block();
+        }
+
+        result<std::size_t> forward(std::size_t n) noexcept {
+            if (n == 0) return ok<std::size_t>(0u);
+            auto r = base.write(bytes{reinterpret_cast<const std::byte*>(buf.data()), n});
+            if (!r) return r;
+            // Keep the open block (if any) that follows the forwarded bytes.
+            std::memmove(buf.data(), buf.data() + n, len - n);
+            len -= n;
+            code_at = (code_at >= n) ? code_at - n : 0;
+            return r;
+        }
+
+        std::array<unsigned char, N> buf{};
+        std::size_t len = 0;      // encoded bytes in buf
+        std::size_t code_at = 0;  // index of the open block's code byte
+        std::size_t code = 1;     // open block length + 1
+        bool in_frame = false;
+    };
+
+    // Host-side streaming COBS decoder. feed() accepts arbitrary chunks and calls
+    // on_frame(bytes) for every complete frame. Frames longer than N bytes or cut
+    // short by a delimiter are dropped and counted in errors.
+    template <std::size_t N = 1024>
+    struct cobs_decoder {
+        std::size_t errors = 0;
+
+        template <class F>
+        void feed(bytes in, F&& on_frame) {
+            for (std::byte x : in) {
+                const auto c = static_cast<unsigned char>(x);
+                if (c == 0) {
+                    if (started && left == 0 && !bad) on_frame(bytes{buf.data(), len});
+                    else if (started) ++errors;
+                    reset();
+                } else if (bad) {
+                    continue;
+                } else if (left == 0) {
+                    // Code byte: every block but a full one implies a zero before the next.
+                    if (started && code != 0xFF) put(std::byte{0});
+                    code = c;
+                    left = c - 1u;
+                    started = true;
+                } else {
+                    put(x);
+                    --left;
+                }
+            }
+        }
+
+        void reset() noexcept {
+            len = 0;
+            left = 0;
+            code = 0;
+            started = false;
+            bad = false;
+        }
+
+      private:
+        void put(std::byte b) noexcept {
+            if (len == N) {
+                bad = true;
+                return;
+            }
+            buf[len++] = b;
+        }
+
+        std::array<std::byte, N> buf{};
+        std::size_t len = 0;
+        unsigned left = 0;   // data bytes remaining in the current block
+        unsigned code = 0;
+        bool started = false;
+        bool bad = false;
+    };
+
+
+    // ------------------------------------------------------------------
+    // CRC-32 (IEEE 802.3, reflected 0xEDB88320), usable incrementally:
+    //   std::uint32_t st = crc32_init; st = crc32_update(st, a); ...; crc32_final(st)
+
+    inline constexpr std::uint32_t crc32_init = 0xFFFFFFFFu;
+
+    namespace detail {
+#if defined(OUT_CRC_SLICE8)
+        inline constexpr auto crc32_tables = [] {
+            std::array<std::array<std::uint32_t, 256>, 8> t{};
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c >> 1) ^ ((c & 1u) ? 0xEDB88320u : 0u);
+                t[0][i] = c;
+            }
+            for (std::size_t k = 1; k < 8; ++k) {
+                for (std::size_t i = 0; i < 256; ++i) {
+                    t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFFu];
+                }
+            }
+            return t;
+        }();
+
+        constexpr std::uint32_t load_le32(const unsigned char* p) noexcept {
+            return std::uint32_t{p[0]} | (std::uint32_t{p[1]} << 8) |
+                   (std::uint32_t{p[2]} << 16) | (std::uint32_t{p[3]} << 24);
+        }
+#else
+        inline constexpr auto crc32_nibbles = [] {
+            std::array<std::uint32_t, 16> t{};
+            for (std::uint32_t i = 0; i < 16; ++i) {
+                std::uint32_t c = i;
+                for (int k = 0; k < 4; ++k) c = (c >> 1) ^ ((c & 1u) ? 0xEDB88320u : 0u);
+                t[i] = c;
+            }
+            return t;
+        }();
+#endif
+    }
+
+    inline std::uint32_t crc32_update(std::uint32_t st, bytes b) noexcept {
+        auto p = reinterpret_cast<const unsigned char*>(b.data());
+        std::size_t n = b.size();
+#if defined(OUT_CRC_SLICE8)
+        const auto& t = detail::crc32_tables;
+        for (; n >= 8; p += 8, n -= 8) {
+            const std::uint32_t lo = detail::load_le32(p) ^ st;
+            const std::uint32_t hi = detail::load_le32(p + 4);
+            st = t[7][lo & 0xFFu] ^ t[6][(lo >> 8) & 0xFFu] ^ t[5][(lo >> 16) & 0xFFu] ^ t[4][lo >> 24] ^
+                 t[3][hi & 0xFFu] ^ t[2][(hi >> 8) & 0xFFu] ^ t[1][(hi >> 16) & 0xFFu] ^ t[0][hi >> 24];
+        }
+        for (; n != 0; ++p, --n) st = (st >> 8) ^ t[0][(st ^ *p) & 0xFFu];
+#else
+        const auto& t = detail::crc32_nibbles;
+        for (; n != 0; ++p, --n) {
+            st = (st >> 4) ^ t[(st ^ *p) & 0xFu];
+            st = (st >> 4) ^ t[(st ^ (*p >> 4)) & 0xFu];
+        }
+#endif
+        return st;
+    }
+
+    constexpr std::uint32_t crc32_final(std::uint32_t st) noexcept { return ~st; }
+
+    inline std::uint32_t crc32(bytes b) noexcept { return crc32_final(crc32_update(crc32_init, b)); }
+
+    // 8) Record trailer for loss detection: end_record() appends an 8-byte trailer
+    // [seq u32 LE][crc32 u32 LE] to every record, where the CRC covers the record
+    // bytes and seq. The CRC is updated as bytes pass through write(), while they
+    // are still hot in cache, so no second pass is needed. Put it in front of a
+    // framing sink (cobs_framing_sink) so the receiver can find record ends; check
+    // records with record_checker.
+    template <Sink BaseSink>
+    struct crc_trailer_sink {
+        BaseSink& base;
+
+        explicit crc_trailer_sink(BaseSink& s, std::uint32_t first_seq = 0) noexcept
+            : base(s), seq(first_seq) {}
+
+        result<std::size_t> write(bytes b) noexcept {
+            auto r = base.write(b);
+            // Only bytes the base accepted are covered by the CRC.
+            if (r) crc = crc32_update(crc, b.first(*r < b.size() ? *r : b.size()));
+            return r;
+        }
+
+        // Passes the logger's record hook (level, domain) on to a base that has one.
+        template <class Level, class B = BaseSink>
+          requires requires(B& b, Level l, std::string_view d) { b.begin_record(l, d); }
+        void begin_record(Level l, std::string_view domain) noexcept { base.begin_record(l, domain); }
+
+        result<std::size_t> end_record() noexcept {
+            unsigned char t[8];
+            for (int i = 0; i < 4; ++i) t[i] = static_cast<unsigned char>(seq >> (8 * i));
+            crc = crc32_update(crc, bytes{reinterpret_cast<const std::byte*>(t), 4});
+            const std::uint32_t c = crc32_final(crc);
+            for (int i = 0; i < 4; ++i) t[4 + i] = static_cast<unsigned char>(c >> (8 * i));
+            ++seq;
+            crc = crc32_init;
+            auto r = base.write(bytes{reinterpret_cast<const std::byte*>(t), sizeof(t)});
+            if (!r) return std::unexpected(r.error());
+            if constexpr (RecordSink<BaseSink>) {
+                return base.end_record();
+            } else {
+                return ok<std::size_t>(0u);
+            }
+        }
+
+        template <class B = BaseSink>
+          requires Flushable<B>
+        result<std::size_t> flush() noexcept { return base.flush(); }
+
+        std::uint32_t next_seq() const noexcept { return seq; }
+
+      private:
+        std::uint32_t seq;
+        std::uint32_t crc = crc32_init;
+    };
+
+    // Receiver side of crc_trailer_sink: validates whole records (e.g. frames
+    // from cobs_decoder) and keeps counts of lost and corrupt records. The first
+    // valid record sets the expected sequence number. A sequence number that
+    // goes backwards (the sender restarted) or jumps ahead by more than max_gap
+    // starts a new stream: it is counted in resyncs, not in lost.
+    struct record_checker {
+        enum class status : std::uint8_t { ok, gap, resync, corrupt };
+
+        std::uint32_t max_gap = 1u << 16;  // larger forward jumps are treated as a restart
+        std::uint64_t received = 0;  // valid records
+        std::uint64_t lost = 0;      // records missing between sequence numbers
+        std::uint64_t corrupt = 0;   // records with a bad CRC or no trailer
+        std::uint64_t resyncs = 0;   // sender restarts / sequence discontinuities
+
+        // On ok/gap/resync, payload (if given) receives the record without its trailer.
+        status check(bytes rec, bytes* payload = nullptr) noexcept {
+            if (rec.size() < 8) {
+                ++corrupt;
+                return status::corrupt;
+            }
+            auto p = reinterpret_cast<const unsigned char*>(rec.data()) + rec.size() - 8;
+            std::uint32_t seq = 0, c = 0;
+            for (int i = 0; i < 4; ++i) {
+                seq |= std::uint32_t{p[i]} << (8 * i);
+                c |= std::uint32_t{p[4 + i]} << (8 * i);
+            }
+            if (crc32(rec.first(rec.size() - 4)) != c) {
+                ++corrupt;
+                return status::corrupt;
+            }
+            if (payload) *payload = rec.first(rec.size() - 8);
+            ++received;
+            // Modulo 2^32: a backwards step wraps to a huge value.
+            const std::uint32_t missed = seq - expected;
+            expected = seq + 1;
+            if (!synced || missed == 0) {
+                synced = true;
+                return status::ok;
+            }
+            if (missed > max_gap) {
+                ++resyncs;
+                return status::resync;
+            }
+            lost += missed;
+            return status::gap;
+        }
+
+      private:
+        std::uint32_t expected = 0;
+        bool synced = false;
+    };
+
+
+    // 9) Bip buffer (bipartite circular buffer), single producer / single consumer.
+    // Unlike a plain ring, every reservation and every readable region is
+    // contiguous, so a record never wraps and a region can go straight to a DMA
+    // transfer or write(2) without a bounce copy. Typical UART DMA drain:
+    //   auto r = bip.read(); if (!r.empty()) dma_start(r.data(), r.size());
+    //   ...in the completion callback: bip.release(n);
+    // The producer side (reserve/commit, write) and the consumer side
+    // (read/release) may run on different threads or in an ISR; each side itself
+    // is single-threaded. write() never blocks: it fails with errc::would_block
+    // while the consumer has not freed enough contiguous space.
+    template <std::size_t N = 1024>
+    struct bip_buffer_sink {
+        static_assert(N >= 2, "bip buffer too small");
+
+        // Producer: contiguous space for exactly n bytes, or an empty span. A request
+        // of at most N / 2 bytes always succeeds once the consumer has caught up.
+        std::span<std::byte> reserve(std::size_t n) noexcept {
+            const std::size_t w = write_.load(std::memory_order_relaxed);
+            const std::size_t r = read_.load(std::memory_order_acquire);
+            std::size_t start;
+            if (w < r) {
+                // Inverted: free space is [w, r); keep one byte so w never reaches r.
+                if (w + n >= r) return {};
+                start = w;
+            } else if (n <= N - w) {
+                start = w;
+            } else if (n < r) {
+                start = 0;  // wrap; [w, N) stays unused until the consumer passes it
+            } else {
+                return {};
+            }
+            res_start = start;
+            return {buf_.data() + start, n};
+        }
+
+        // Producer: publishes the first used bytes of the last reservation.
+        void commit(std::size_t used) noexcept {
+            const std::size_t w = write_.load(std::memory_order_relaxed);
+            const std::size_t new_w = res_start + used;
+            if (new_w < w && w != N) {
+                // Wrapped: data before the wrap ends at w.
+                last_.store(w, std::memory_order_release);
+            } else if (new_w > last_.load(std::memory_order_relaxed)) {
+                last_.store(N, std::memory_order_release);
+            }
+            write_.store(new_w, std::memory_order_release);
+        }
+
+        result<std::size_t> write(bytes b) noexcept {
+            if (b.size() > N / 2) return std::unexpected(errc::buffer_overflow);
+            auto dst = reserve(b.size());
+            if (dst.size() != b.size()) return std::unexpected(errc::would_block);
+            std::memcpy(dst.data(), b.data(), b.size());
+            commit(b.size());
+            return ok(b.size());
+        }
+
+        // Consumer: the oldest contiguous committed region (may be empty).
+        bytes read() noexcept {
+            const std::size_t w = write_.load(std::memory_order_acquire);
+            const std::size_t last = last_.load(std::memory_order_acquire);
+            std::size_t r = read_.load(std::memory_order_relaxed);
+            if (r == last && w < r) {
+                // Producer wrapped and everything up to the watermark was consumed.
+                r = 0;
+                read_.store(0, std::memory_order_release);
+            }
+            const std::size_t end = (w < r) ? last : w;
+            return {buf_.data() + r, end - r};
+        }
+
+        // Consumer: frees n bytes from the front of the region returned by read().
+        void release(std::size_t n) noexcept {
+            read_.fetch_add(n, std::memory_order_release);
+        }
+
+      private:
+        std::array<std::byte, N> buf_{};
+        std::atomic<std::size_t> write_{0};  // producer: end of committed data
+        std::atomic<std::size_t> read_{0};   // consumer: start of unread data
+        std::atomic<std::size_t> last_{0};   // producer: end of valid data before a wrap
+        std::size_t res_start = 0;           // producer: start of the pending reservation
     };
 
 }
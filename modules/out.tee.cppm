@@ -0,0 +1,118 @@
+module;
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+export module out.tee;
+// Dependency contract (DO NOT VIOLATE)
+// Allowed out.* imports: out.core, out.sink, out.domain, out.ansi
+// Forbidden out.* imports: out.format, out.logger, out.api, out.port, out.print
+// Rationale: fan-out of already formatted bytes; formatting happens once, upstream.
+// If you need functionality from a higher layer, add an extension point in this layer instead.
+
+import out.ansi;
+import out.core;
+import out.domain;
+import out.sink;
+
+export namespace out {
+
+    // Format-once fan-out: the logger formats a record once and the tee hands the
+    // same bytes to every child sink. Each child has its own runtime minimum
+    // level (levels[i], default trace = everything) and its own ANSI capability:
+    // write_ansi() reaches only children that have write_ansi() (wrap a terminal in
+    // ansi_sink_ref<..., true> to keep colors there; a plain UART/file gets none).
+    // Record hooks (begin_record/end_record) and flush() are forwarded to children
+    // that support them. A failing child does not stop the others; the first
+    // error is reported after all children were tried. Holds pointers only.
+    template <Sink... Sinks>
+    struct tee_sink {
+        static constexpr std::size_t count = sizeof...(Sinks);
+        static_assert(count != 0 && count <= 32, "tee_sink supports 1..32 children");
+
+        std::tuple<Sinks*...> sinks;
+        std::array<level, count> levels;
+
+        explicit tee_sink(Sinks&... s) noexcept : sinks{&s...} { levels.fill(level::trace); }
+
+        void set_level(std::size_t i, level l) noexcept {
+            if (i < count) levels[i] = l;
+        }
+
+        // Called by the logger before the record's bytes; selects the children
+        // whose threshold admits this level.
+        void begin_record(level l, std::string_view domain) noexcept {
+            active = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (l != level::off && l <= levels[i]) active |= std::uint32_t{1} << i;
+            }
+            (void)each([&](auto& c) -> result<std::size_t> {
+                if constexpr (requires { c.begin_record(l, domain); }) c.begin_record(l, domain);
+                return ok<std::size_t>(0u);
+            });
+        }
+
+        result<std::size_t> write(bytes b) noexcept {
+            auto r = each([&](auto& c) { return c.write(b); });
+            if (!r) return std::unexpected(r.error());
+            return ok(b.size());
+        }
+
+        result<std::size_t> write_ansi(std::string_view sv) noexcept {
+            auto r = each([&](auto& c) -> result<std::size_t> {
+                if constexpr (ansi::AnsiSink<std::remove_reference_t<decltype(c)>>) return c.write_ansi(sv);
+                else return ok<std::size_t>(0u);
+            });
+            if (!r) return std::unexpected(r.error());
+            return ok(sv.size());
+        }
+
+        result<std::size_t> end_record() noexcept {
+            auto r = each([](auto& c) -> result<std::size_t> {
+                if constexpr (RecordSink<std::remove_reference_t<decltype(c)>>) return c.end_record();
+                else return ok<std::size_t>(0u);
+            });
+            active = all;
+            if (!r) return std::unexpected(r.error());
+            return ok<std::size_t>(0u);
+        }
+
+        result<std::size_t> flush() noexcept {
+            auto r = each([](auto& c) -> result<std::size_t> {
+                if constexpr (Flushable<std::remove_reference_t<decltype(c)>>) return c.flush();
+                else return ok<std::size_t>(0u);
+            });
+            if (!r) return std::unexpected(r.error());
+            return ok<std::size_t>(0u);
+        }
+
+      private:
+        static constexpr std::uint32_t all =
+            (count == 32) ? ~std::uint32_t{0} : ((std::uint32_t{1} << count) - 1);
+
+        // Applies f to every active child; returns the first error, if any.
+        template <class F>
+        result<std::size_t> each(F&& f) noexcept {
+            result<std::size_t> first = ok<std::size_t>(0u);
+            [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+                ([&] {
+                    if (active & (std::uint32_t{1} << Is)) {
+                        auto r = f(*std::get<Is>(sinks));
+                        if (!r && first) first = std::unexpected(r.error());
+                    }
+                }(), ...);
+            }(std::index_sequence_for<Sinks...>{});
+            return first;
+        }
+
+        std::uint32_t active = all;  // children selected for the current record
+    };
+
+    template <class... Sinks>
+    tee_sink(Sinks&...) -> tee_sink<Sinks...>;
+
+}